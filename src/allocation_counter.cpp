@@ -0,0 +1,70 @@
+#include "allocation_counter.h"
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+namespace dg::allocation_counter{
+
+    static std::atomic<size_t> allocation_count{};
+
+    static auto counted_malloc(size_t sz) -> void *{
+
+        allocation_count.fetch_add(1u, std::memory_order_relaxed);
+
+        if (void * rs = malloc(sz == 0u ? 1u : sz)){
+            return rs;
+        }
+
+        throw std::bad_alloc();
+    }
+
+    static auto counted_aligned_alloc(size_t sz, std::align_val_t alignment) -> void *{
+
+        allocation_count.fetch_add(1u, std::memory_order_relaxed);
+        size_t align    = static_cast<size_t>(alignment);
+        size_t rounded  = (sz + align - 1u) / align * align;
+
+        if (void * rs = aligned_alloc(align, rounded == 0u ? align : rounded)){
+            return rs;
+        }
+
+        throw std::bad_alloc();
+    }
+
+    auto count() noexcept -> size_t{
+
+        return allocation_count.load(std::memory_order_relaxed);
+    }
+}
+
+//the nothrow and array forms forward to these by default
+
+void * operator new(size_t sz){
+
+    return dg::allocation_counter::counted_malloc(sz);
+}
+
+void * operator new(size_t sz, std::align_val_t alignment){
+
+    return dg::allocation_counter::counted_aligned_alloc(sz, alignment);
+}
+
+void operator delete(void * ptr) noexcept{
+
+    free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept{
+
+    free(ptr);
+}
+
+void operator delete(void * ptr, std::align_val_t) noexcept{
+
+    free(ptr);
+}
+
+void operator delete(void * ptr, size_t, std::align_val_t) noexcept{
+
+    free(ptr);
+}
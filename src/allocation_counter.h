@@ -0,0 +1,14 @@
+#ifndef __DG_ALLOCATION_COUNTER_H__
+#define __DG_ALLOCATION_COUNTER_H__
+
+#include <stddef.h>
+
+//global operator new calls since startup - link allocation_counter.cpp (it replaces operator new / delete) into the binary that reads it
+//own translation unit - replacement operators defined next to inlined std containers trigger -Wmismatched-new-delete
+
+namespace dg::allocation_counter{
+
+    auto count() noexcept -> size_t;
+}
+
+#endif
@@ -0,0 +1,977 @@
+#include "ud_sym_encoder.h"
+#include "allocation_counter.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <utility>
+#include <functional>
+#include <vector>
+#include <string>
+#include <memory_resource>
+#include <thread>
+
+//cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target ud_sym_bench && ./build/ud_sym_bench
+//every benchmark reports bytes_per_second and allocs/op (global operator new calls per iteration, counted by allocation_counter.cpp)
+
+namespace bench{
+
+    //the full 16B - 64MB sweep is for the paths that run at memory speed, the per-byte dict paths (~1 MB/s) stop at 1MB - 64MB would take minutes per iteration
+    static constexpr int64_t MIN_SIZE           = 16;
+    static constexpr int64_t MAX_SIZE           = int64_t{1} << 26;
+    static constexpr int64_t MAX_DICT_SIZE      = int64_t{1} << 20;
+    static constexpr int64_t SIZE_MULTIPLIER    = 16;
+
+    //counts the allocations of the timed loop - construct right before it, call finish() right after
+    class Probe{
+
+        private:
+
+            benchmark::State& state;
+            size_t first_allocation_count;
+
+        public:
+
+            Probe(benchmark::State& state) noexcept: state(state), first_allocation_count(dg::allocation_counter::count()){}
+
+            void finish(size_t bytes_per_op){
+
+                size_t allocs                       = dg::allocation_counter::count() - this->first_allocation_count;
+                this->state.counters["allocs/op"]   = benchmark::Counter(static_cast<double>(allocs), benchmark::Counter::kAvgIterations);
+                this->state.SetBytesProcessed(static_cast<int64_t>(this->state.iterations()) * static_cast<int64_t>(bytes_per_op));
+            }
+    };
+
+    //forces one cpu_dispatch path for the benchmark - skipped on cpus without it
+    class IsaScope{
+
+        public:
+
+            IsaScope(benchmark::State& state, dg::cpu_dispatch::Isa isa){
+
+                if (isa > dg::cpu_dispatch::detect_isa()){
+                    state.SkipWithError("isa not supported by this cpu");
+                    return;
+                }
+
+                dg::cpu_dispatch::set_isa(isa);
+            }
+
+            ~IsaScope() noexcept{
+
+                dg::cpu_dispatch::reset_isa();
+            }
+    };
+
+    auto random_string(size_t sz) -> std::string{
+
+        auto rand_gen   = std::bind(std::uniform_int_distribution<char>{}, std::mt19937{});
+        std::string rs(sz, ' ');
+        std::generate(rs.begin(), rs.end(), std::ref(rand_gen));
+
+        return rs;
+    }
+
+    auto secret() -> const std::string&{
+
+        static const std::string rs = "my_secret";
+        return rs;
+    }
+
+    auto uint_secret() -> uint64_t{
+
+        return dg::hasher::murmur_hash(secret().data(), secret().size());
+    }
+
+    //the pre-engine per-byte dict (one vector + iota per byte) - kept as the baseline for the permutation engine
+    template <class Randomizer>
+    auto legacy_byte_dict(Randomizer& randomizer) -> std::vector<uint8_t>{
+
+        std::vector<uint8_t> rs(256);
+        std::iota(rs.begin(), rs.end(), 0u);
+
+        for (size_t i = 0u; i < 256; ++i){
+            size_t lhs_idx = static_cast<size_t>(randomizer()) % 256;
+            size_t rhs_idx = static_cast<size_t>(randomizer()) % 256;
+            std::swap(rs[lhs_idx], rs[rhs_idx]);
+        }
+
+        return rs;
+    }
+
+    //small strings, small maps, small ints - the mix the varint formats are meant for
+    struct MixedMessage{
+        uint32_t id;
+        int64_t delta;
+        std::string name;
+        std::unordered_map<std::string, uint32_t> tags;
+        std::vector<int32_t> samples;
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector) const{
+            reflector(id, delta, name, tags, samples);
+        }
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector){
+            reflector(id, delta, name, tags, samples);
+        }
+    };
+
+    auto mixed_messages(size_t sz) -> std::vector<MixedMessage>{
+
+        auto rand_gen   = std::mt19937{};
+        auto rs         = std::vector<MixedMessage>(sz);
+
+        for (auto& msg: rs){
+            msg.id      = rand_gen() % 100000u;
+            msg.delta   = static_cast<int64_t>(rand_gen() % 2000u) - 1000;
+            msg.name    = random_string(4u + rand_gen() % 24u);
+
+            for (size_t i = 0u, tag_sz = rand_gen() % 4u; i < tag_sz; ++i){
+                msg.tags[random_string(6u)] = rand_gen() % 1000u;
+            }
+
+            for (size_t i = 0u, sample_sz = rand_gen() % 8u; i < sample_sz; ++i){
+                msg.samples.push_back(static_cast<int32_t>(rand_gen() % 512u) - 256);
+            }
+        }
+
+        return rs;
+    }
+
+    auto nested_object(size_t sz) -> std::unordered_map<uint32_t, std::vector<std::string>>{
+
+        auto rs = std::unordered_map<uint32_t, std::vector<std::string>>{};
+
+        for (size_t i = 0u; i < sz; ++i){
+            rs[i] = std::vector<std::string>(4, random_string(32));
+        }
+
+        return rs;
+    }
+
+    //hasher
+
+    void murmur_hash(benchmark::State& state){
+
+        size_t sz       = state.range(0);
+        std::string inp = random_string(sz);
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(dg::hasher::murmur_hash(inp.data(), inp.size()));
+        }
+
+        probe.finish(sz);
+    }
+
+    void murmur_hash128(benchmark::State& state){
+
+        size_t sz       = state.range(0);
+        std::string inp = random_string(sz);
+        uint64_t seed   = uint_secret();
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(dg::hasher::murmur_hash128(inp.data(), inp.size(), seed));
+        }
+
+        probe.finish(sz);
+    }
+
+    //fixed-size keys - runtime length vs the compile-time LEN overload
+    template <size_t LEN, bool IS_STATIC>
+    void murmur_hash128_fixed(benchmark::State& state){
+
+        std::string inp = random_string(LEN);
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(inp.data());
+
+            if constexpr(IS_STATIC){
+                benchmark::DoNotOptimize(dg::hasher::murmur_hash128(inp.data(), std::integral_constant<size_t, LEN>{}));
+            } else{
+                benchmark::DoNotOptimize(dg::hasher::murmur_hash128(inp.data(), inp.size()));
+            }
+        }
+
+        probe.finish(LEN);
+    }
+
+    template <bool IS_BATCHED>
+    void murmur_hash_many(benchmark::State& state){
+
+        constexpr size_t BATCH_SZ   = 1024u;
+        size_t sz                   = state.range(0);
+        auto msgs                   = std::vector<std::string>(BATCH_SZ, random_string(sz));
+        auto bufs                   = std::vector<const char *>{};
+        auto lens                   = std::vector<size_t>{};
+        auto out                    = std::vector<uint64_t>(BATCH_SZ);
+
+        for (const auto& msg: msgs){
+            bufs.push_back(msg.data());
+            lens.push_back(msg.size());
+        }
+
+        auto probe = Probe(state);
+
+        for (auto _: state){
+            if constexpr(IS_BATCHED){
+                dg::hasher::murmur_hash_many(bufs.data(), lens.data(), BATCH_SZ, 0xFF, out.data());
+            } else{
+                dg::hasher::murmur_hash_many_scalar(bufs.data(), lens.data(), BATCH_SZ, 0xFF, out.data());
+            }
+
+            benchmark::DoNotOptimize(out.data());
+        }
+
+        probe.finish(sz * BATCH_SZ);
+    }
+
+    template <dg::cpu_dispatch::Isa ISA>
+    void murmur_hash_many_isa(benchmark::State& state){
+
+        auto isa_scope = IsaScope(state, ISA);
+        murmur_hash_many<true>(state);
+    }
+
+    //compact_serializer
+
+    void serializer_size(benchmark::State& state){
+
+        auto obj    = nested_object(state.range(0));
+        auto probe  = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(dg::compact_serializer::size(obj));
+        }
+
+        probe.finish(dg::compact_serializer::size(obj));
+    }
+
+    void serializer_serialize_string(benchmark::State& state){
+
+        size_t sz       = state.range(0);
+        std::string inp = random_string(sz);
+        std::string buf(dg::compact_serializer::size(inp), ' ');
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            dg::compact_serializer::serialize_into(buf.data(), inp);
+            benchmark::DoNotOptimize(buf.data());
+        }
+
+        probe.finish(sz);
+    }
+
+    template <bool IS_CHECKED>
+    void serializer_deserialize_string(benchmark::State& state){
+
+        size_t sz       = state.range(0);
+        std::string buf = dg::compact_serializer::serialize(random_string(sz));
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            std::string out{};
+
+            if constexpr(IS_CHECKED){
+                dg::compact_serializer::deserialize_into(out, buf.data(), buf.data() + buf.size(), {sz});
+            } else{
+                dg::compact_serializer::deserialize_into(out, buf.data());
+            }
+
+            benchmark::DoNotOptimize(out.data());
+        }
+
+        probe.finish(sz);
+    }
+
+    //counter pre-walk + raw buffer vs one traversal into a growable sink
+    template <bool IS_ONE_PASS>
+    void serializer_serialize_nested(benchmark::State& state){
+
+        auto obj    = nested_object(state.range(0));
+        auto probe  = Probe(state);
+
+        for (auto _: state){
+            if constexpr(IS_ONE_PASS){
+                benchmark::DoNotOptimize(dg::compact_serializer::serialize(obj));
+            } else{
+                std::string out(dg::compact_serializer::size(obj), ' ');
+                dg::compact_serializer::serialize_into(out.data(), obj);
+                benchmark::DoNotOptimize(out.data());
+            }
+        }
+
+        probe.finish(dg::compact_serializer::size(obj));
+    }
+
+    void serializer_deserialize_nested(benchmark::State& state){
+
+        std::string buf = dg::compact_serializer::serialize(nested_object(state.range(0)));
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            auto obj = std::unordered_map<uint32_t, std::vector<std::string>>{};
+            dg::compact_serializer::deserialize_into(obj, buf.data());
+            benchmark::DoNotOptimize(obj);
+        }
+
+        probe.finish(buf.size());
+    }
+
+    //bytes are wire bytes - compare formats by items_per_second, wire_bytes is the encoded size of the whole set
+    template <class Format>
+    void serializer_format_serialize(benchmark::State& state){
+
+        auto msgs   = mixed_messages(state.range(0));
+        size_t wire = 0u;
+
+        for (const auto& msg: msgs){
+            wire += dg::compact_serializer::size<Format>(msg);
+        }
+
+        std::string out{};
+        auto probe = Probe(state);
+
+        for (auto _: state){
+            for (const auto& msg: msgs){
+                out.clear();
+                dg::compact_serializer::serialize_into<Format>(out, msg);
+            }
+
+            benchmark::DoNotOptimize(out.data());
+        }
+
+        probe.finish(wire);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(msgs.size()));
+        state.counters["wire_bytes"] = static_cast<double>(wire);
+    }
+
+    template <class Format, bool IS_CHECKED>
+    void serializer_format_deserialize(benchmark::State& state){
+
+        auto msgs       = mixed_messages(state.range(0));
+        auto encoded    = std::vector<std::string>{};
+        size_t wire     = 0u;
+
+        for (const auto& msg: msgs){
+            encoded.push_back(dg::compact_serializer::serialize<Format>(msg));
+            wire += encoded.back().size();
+        }
+
+        auto probe = Probe(state);
+
+        for (auto _: state){
+            for (const auto& buf: encoded){
+                MixedMessage msg{};
+
+                if constexpr(IS_CHECKED){
+                    dg::compact_serializer::deserialize_into<Format>(msg, buf.data(), buf.data() + buf.size());
+                } else{
+                    dg::compact_serializer::deserialize_into<Format>(msg, buf.data());
+                }
+
+                benchmark::DoNotOptimize(msg);
+            }
+        }
+
+        probe.finish(wire);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(msgs.size()));
+        state.counters["wire_bytes"] = static_cast<double>(wire);
+    }
+
+    //encoders - measured through the std::string api (what main.cpp and most callers use), the span api where it differs
+
+    template <class Encoder>
+    void encode(benchmark::State& state, Encoder& encoder){
+
+        size_t sz       = state.range(0);
+        std::string inp = random_string(sz);
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(encoder.encode(inp));
+        }
+
+        probe.finish(sz);
+    }
+
+    template <class Encoder>
+    void decode(benchmark::State& state, Encoder& encoder){
+
+        size_t sz       = state.range(0);
+        std::string enc = encoder.encode(random_string(sz));
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(encoder.decode(enc));
+        }
+
+        probe.finish(sz);
+    }
+
+    //span overloads into preallocated buffers - for the GB/s encoders, where a fresh std::string per op would dominate
+    template <class Encoder>
+    void encode_span(benchmark::State& state, Encoder& encoder){
+
+        size_t sz       = state.range(0);
+        std::string inp = random_string(sz);
+        std::string out(encoder.encoded_size(sz), ' ');
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(encoder.encode(std::span<const char>(inp), std::span<char>(out)));
+        }
+
+        probe.finish(sz);
+    }
+
+    template <class Encoder>
+    void decode_span(benchmark::State& state, Encoder& encoder){
+
+        size_t sz       = state.range(0);
+        std::string enc = encoder.encode(random_string(sz));
+        std::string out(encoder.max_decoded_size(enc.size()), ' ');
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(encoder.decode(std::span<const char>(enc), std::span<char>(out)));
+        }
+
+        probe.finish(sz);
+    }
+
+    auto make_murmur() -> dg::ud_sym_encoder::MurMurEncoder{
+
+        return dg::ud_sym_encoder::MurMurEncoder(uint_secret());
+    }
+
+    auto make_mt19937() -> dg::ud_sym_encoder::Mt19937Encoder{
+
+        return dg::ud_sym_encoder::Mt19937Encoder(secret(), dg::ud_sym_encoder::mt19937{});
+    }
+
+    auto make_double() -> dg::ud_sym_encoder::DoubleEncoder{
+
+        return dg::ud_sym_encoder::DoubleEncoder(std::make_unique<dg::ud_sym_encoder::MurMurEncoder>(uint_secret()),
+                                                 std::make_unique<dg::ud_sym_encoder::Mt19937Encoder>(secret(), dg::ud_sym_encoder::mt19937{}));
+    }
+
+    void murmur_encode(benchmark::State& state){
+
+        auto encoder = make_murmur();
+        encode(state, encoder);
+    }
+
+    void murmur_decode(benchmark::State& state){
+
+        auto encoder = make_murmur();
+        decode(state, encoder);
+    }
+
+    void murmur_keyed_encode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::MurMurEncoder(uint_secret(), dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+        encode(state, encoder);
+    }
+
+    void murmur_keyed_decode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::MurMurEncoder(uint_secret(), dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+        decode(state, encoder);
+    }
+
+    void murmur_decode_view(benchmark::State& state){
+
+        auto encoder    = make_murmur();
+        size_t sz       = state.range(0);
+        std::string enc = encoder.encode(random_string(sz));
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(encoder.decode_view(enc));
+        }
+
+        probe.finish(sz);
+    }
+
+    void mt19937_encode(benchmark::State& state){
+
+        auto encoder = make_mt19937();
+        encode(state, encoder);
+    }
+
+    void mt19937_decode(benchmark::State& state){
+
+        auto encoder = make_mt19937();
+        decode(state, encoder);
+    }
+
+    void double_encode(benchmark::State& state){
+
+        auto encoder = make_double();
+        encode(state, encoder);
+    }
+
+    void double_decode(benchmark::State& state){
+
+        auto encoder = make_double();
+        decode(state, encoder);
+    }
+
+    void spawn_encode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::spawn_encoder(secret());
+        encode(state, *encoder);
+    }
+
+    void spawn_decode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::spawn_encoder(secret());
+        decode(state, *encoder);
+    }
+
+    //the keyed frame - one integrity hash pass instead of two
+    void spawn_keyed_encode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::spawn_keyed_encoder(secret());
+        encode(state, *encoder);
+    }
+
+    void spawn_keyed_decode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::spawn_keyed_encoder(secret());
+        decode(state, *encoder);
+    }
+
+    void philox_encode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+        encode(state, encoder);
+    }
+
+    void philox_decode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+        decode(state, encoder);
+    }
+
+    //one PhiloxStream refill - 32 blocks, the draws of one byte dict
+    template <dg::cpu_dispatch::Isa ISA>
+    void philox_fill(benchmark::State& state){
+
+        constexpr size_t NBLOCKS    = dg::ud_sym_encoder::PhiloxStream::BUFFER_BLOCKS;
+        auto isa_scope              = IsaScope(state, ISA);
+        auto out                    = std::array<uint8_t, NBLOCKS * 16u>{};
+        uint64_t ctr                = 0u;
+        auto probe                  = Probe(state);
+
+        for (auto _: state){
+            dg::ud_sym_encoder::Philox4x32::fill({0x12345678u, 0x9ABCDEF0u}, ctr, NBLOCKS, out.data());
+            benchmark::DoNotOptimize(out.data());
+            ctr += NBLOCKS;
+        }
+
+        probe.finish(out.size());
+    }
+
+    template <dg::cpu_dispatch::Isa ISA>
+    void philox_encode_isa(benchmark::State& state){
+
+        auto isa_scope = IsaScope(state, ISA);
+        philox_encode(state);
+    }
+
+    //range(0) payload bytes decoded by range(1) threads - real time, the work is spread over threads spawned inside decode_parallel
+    void philox_decode_parallel(benchmark::State& state){
+
+        auto encoder        = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+        size_t sz           = state.range(0);
+        size_t thread_count = state.range(1);
+        std::string enc     = encoder.encode(random_string(sz));
+        std::string out(sz, ' ');
+        auto probe          = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(encoder.decode_parallel(std::span<const char>(enc), std::span<char>(out), thread_count));
+        }
+
+        probe.finish(sz);
+    }
+
+    //range(1) bytes out of the middle of a range(0) byte payload
+    void philox_decode_range(benchmark::State& state){
+
+        auto encoder        = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+        size_t sz           = state.range(0);
+        size_t len          = state.range(1);
+        std::string enc     = encoder.encode(random_string(sz));
+        std::string out(len, ' ');
+        auto probe          = Probe(state);
+
+        for (auto _: state){
+            encoder.decode_range(std::span<const char>(enc), (sz - len) / 2, std::span<char>(out));
+            benchmark::DoNotOptimize(out.data());
+        }
+
+        probe.finish(len);
+    }
+
+    void parallel_decode_args(benchmark::internal::Benchmark * bench){
+
+        int64_t max_thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+        for (int64_t thread_count = 1; thread_count < max_thread_count; thread_count *= 2){
+            bench->Args({1 << 18, thread_count});
+        }
+
+        bench->Args({1 << 18, max_thread_count});
+    }
+
+    //ByteShuffleEngine under one isa - checked against apply_scalar on every tail length first, the benchmark errors out on a mismatch
+    template <dg::cpu_dispatch::Isa ISA>
+    void byte_shuffle(benchmark::State& state){
+
+        auto isa_scope  = IsaScope(state, ISA);
+        size_t sz       = state.range(0);
+        std::string inp = random_string(sz + 128u);
+        std::string out(sz + 128u, ' ');
+        std::string ref(sz + 128u, ' ');
+        auto dict       = dg::ud_sym_encoder::byte_dict_type{};
+        auto randomizer = dg::ud_sym_encoder::mt19937{uint_secret()};
+
+        dg::ud_sym_encoder::ByteDictEngine::make_dict(dict, randomizer);
+
+        for (size_t len = sz; len < sz + 128u; ++len){
+            dg::ud_sym_encoder::ByteShuffleEngine::apply_scalar(dict, inp.data(), len, ref.data());
+            dg::ud_sym_encoder::ByteShuffleEngine::apply(dict, inp.data(), len, out.data());
+
+            if (std::memcmp(ref.data(), out.data(), len) != 0){
+                state.SkipWithError("ByteShuffleEngine::apply differs from apply_scalar");
+                break;
+            }
+        }
+
+        auto probe = Probe(state);
+
+        for (auto _: state){
+            dg::ud_sym_encoder::ByteShuffleEngine::apply(dict, inp.data(), sz, out.data());
+            benchmark::DoNotOptimize(out.data());
+        }
+
+        probe.finish(sz);
+    }
+
+    //range(0) payload bytes, range(1) block size
+    template <dg::cpu_dispatch::Isa ISA>
+    void block_permutation_encode(benchmark::State& state){
+
+        auto isa_scope  = IsaScope(state, ISA);
+        auto encoder    = dg::ud_sym_encoder::BlockPermutationEncoder(secret(), dg::ud_sym_encoder::mt19937{}, state.range(1));
+        encode_span(state, encoder);
+    }
+
+    template <dg::cpu_dispatch::Isa ISA>
+    void block_permutation_decode(benchmark::State& state){
+
+        auto isa_scope  = IsaScope(state, ISA);
+        auto encoder    = dg::ud_sym_encoder::BlockPermutationEncoder(secret(), dg::ud_sym_encoder::mt19937{}, state.range(1));
+        decode_span(state, encoder);
+    }
+
+    void spawn_block_encode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::spawn_block_encoder(secret());
+        encode_span(state, *encoder);
+    }
+
+    void spawn_block_decode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::spawn_block_encoder(secret());
+        decode_span(state, *encoder);
+    }
+
+    //range(0) payload bytes over range(1) threads (default segment sizes) - real time, the workers are spawned inside encode / decode
+    //per-byte dicts by default, IS_BLOCK_CONSTANT for the WeakBlockConstantDicts opt-in (64 KiB blocks)
+    template <bool IS_BLOCK_CONSTANT>
+    auto make_segmented(size_t thread_count) -> dg::ud_sym_encoder::SegmentedEncoder{
+
+        if constexpr(IS_BLOCK_CONSTANT){
+            return dg::ud_sym_encoder::SegmentedEncoder(secret(), dg::ud_sym_encoder::mt19937{}, dg::ud_sym_encoder::WeakBlockConstantDicts{}, thread_count);
+        } else{
+            return dg::ud_sym_encoder::SegmentedEncoder(secret(), dg::ud_sym_encoder::mt19937{}, thread_count);
+        }
+    }
+
+    template <bool IS_BLOCK_CONSTANT>
+    void segmented_encode(benchmark::State& state){
+
+        auto encoder = make_segmented<IS_BLOCK_CONSTANT>(state.range(1));
+        encode_span(state, encoder);
+    }
+
+    template <bool IS_BLOCK_CONSTANT>
+    void segmented_decode(benchmark::State& state){
+
+        auto encoder = make_segmented<IS_BLOCK_CONSTANT>(state.range(1));
+        decode_span(state, encoder);
+    }
+
+    //per-byte dicts run at the draw rate - 1 MiB there, 64 MiB for the block-constant mode
+    template <int64_t SZ>
+    void segmented_args(benchmark::internal::Benchmark * bench){
+
+        int64_t max_thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+        for (int64_t thread_count = 1; thread_count < max_thread_count; thread_count *= 2){
+            bench->Args({SZ, thread_count});
+        }
+
+        bench->Args({SZ, max_thread_count});
+    }
+
+    template <uint8_t Tag>
+    void versioned_encode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::spawn_versioned_encoder(secret(), Tag);
+        encode(state, *encoder);
+    }
+
+    template <uint8_t Tag>
+    void versioned_decode(benchmark::State& state){
+
+        auto encoder = dg::ud_sym_encoder::spawn_versioned_encoder(secret(), Tag);
+        decode(state, *encoder);
+    }
+
+    void spawn_encode_span(benchmark::State& state){
+
+        auto encoder    = dg::ud_sym_encoder::spawn_encoder(secret());
+        size_t sz       = state.range(0);
+        std::string inp = random_string(sz);
+        std::string out(encoder->encoded_size(sz), ' ');
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(encoder->encode(std::span<const char>(inp), std::span<char>(out)));
+        }
+
+        probe.finish(sz);
+    }
+
+    //one shared spawn_encoder instance, no locking - aggregate bytes/s across the benchmark threads
+    void spawn_encode_concurrent(benchmark::State& state){
+
+        static auto encoder = dg::ud_sym_encoder::spawn_encoder(secret());
+        size_t sz           = state.range(0);
+        std::string inp     = random_string(sz);
+        std::string out(encoder->encoded_size(sz), ' ');
+        auto probe          = Probe(state);
+
+        for (auto _: state){
+            benchmark::DoNotOptimize(encoder->encode(std::span<const char>(inp), std::span<char>(out)));
+        }
+
+        probe.finish(sz);
+    }
+
+    template <bool IS_BATCHED>
+    void spawn_encode_many(benchmark::State& state){
+
+        constexpr size_t BATCH_SZ   = 256u;
+        size_t sz                   = state.range(0);
+        auto encoder                = dg::ud_sym_encoder::spawn_encoder(secret());
+        auto msgs                   = std::vector<std::string>(BATCH_SZ, random_string(sz));
+        auto views                  = std::vector<std::string_view>(msgs.begin(), msgs.end());
+        auto arena                  = dg::ud_sym_encoder::OutputArena{};
+        auto probe                  = Probe(state);
+
+        for (auto _: state){
+            if constexpr(IS_BATCHED){
+                encoder->encode_batch(views, arena);
+                benchmark::DoNotOptimize(arena.buf.data());
+            } else{
+                for (const auto& msg: msgs){
+                    benchmark::DoNotOptimize(encoder->encode(msg));
+                }
+            }
+        }
+
+        probe.finish(sz * BATCH_SZ);
+    }
+
+    template <bool IS_BATCHED>
+    void spawn_decode_many(benchmark::State& state){
+
+        constexpr size_t BATCH_SZ   = 256u;
+        size_t sz                   = state.range(0);
+        auto encoder                = dg::ud_sym_encoder::spawn_encoder(secret());
+        auto encoded                = std::vector<std::string>{};
+        auto arena                  = dg::ud_sym_encoder::OutputArena{};
+
+        for (size_t i = 0u; i < BATCH_SZ; ++i){
+            encoded.push_back(encoder->encode(random_string(sz)));
+        }
+
+        auto views = std::vector<std::string_view>(encoded.begin(), encoded.end());
+        auto probe = Probe(state);
+
+        for (auto _: state){
+            if constexpr(IS_BATCHED){
+                encoder->decode_batch(views, arena);
+                benchmark::DoNotOptimize(arena.buf.data());
+            } else{
+                for (const auto& msg: encoded){
+                    benchmark::DoNotOptimize(encoder->decode(msg));
+                }
+            }
+        }
+
+        probe.finish(sz * BATCH_SZ);
+    }
+
+    //decode + deserialize of a nested payload - default allocator vs std::pmr containers over one monotonic arena per op (upstream is null_memory_resource, so the arena path cannot fall back to malloc)
+    template <bool IS_ARENA>
+    void spawn_decode_nested(benchmark::State& state){
+
+        auto encoder    = dg::ud_sym_encoder::spawn_encoder(secret());
+        std::string enc = encoder->encode(dg::compact_serializer::serialize(nested_object(state.range(0))));
+        auto backing    = std::vector<std::byte>(enc.size() * 16u + (size_t{1} << 16));
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            if constexpr(IS_ARENA){
+                auto arena                  = std::pmr::monotonic_buffer_resource(backing.data(), backing.size(), std::pmr::null_memory_resource());
+                std::pmr::string payload    = dg::ud_sym_encoder::decode(*encoder, enc, &arena);
+                auto obj                    = std::pmr::unordered_map<uint32_t, std::pmr::vector<std::pmr::string>>(&arena);
+                dg::compact_serializer::deserialize_into(obj, payload.data());
+                benchmark::DoNotOptimize(obj);
+            } else{
+                std::string payload = encoder->decode(enc);
+                auto obj            = std::unordered_map<uint32_t, std::vector<std::string>>{};
+                dg::compact_serializer::deserialize_into(obj, payload.data());
+                benchmark::DoNotOptimize(obj);
+            }
+        }
+
+        probe.finish(enc.size());
+    }
+
+    //permutation engine
+
+    template <bool IS_LEGACY>
+    void byte_dict(benchmark::State& state){
+
+        size_t sz       = state.range(0);
+        std::string inp = random_string(sz);
+        std::string out(sz, ' ');
+        auto probe      = Probe(state);
+
+        for (auto _: state){
+            auto randomizer = dg::ud_sym_encoder::mt19937{sz};
+
+            if constexpr(IS_LEGACY){
+                for (size_t i = 0u; i < sz; ++i){
+                    out[i] = std::bit_cast<char>(legacy_byte_dict(randomizer)[std::bit_cast<uint8_t>(inp[i])]);
+                }
+            } else{
+                auto dict = dg::ud_sym_encoder::byte_dict_type{};
+
+                for (size_t i = 0u; i < sz; ++i){
+                    dg::ud_sym_encoder::ByteDictEngine::make_dict(dict, randomizer);
+                    out[i] = std::bit_cast<char>(dict[std::bit_cast<uint8_t>(inp[i])]);
+                }
+            }
+
+            benchmark::DoNotOptimize(out.data());
+        }
+
+        probe.finish(sz);
+    }
+}
+
+BENCHMARK(bench::murmur_hash)->Name("murmur_hash")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::murmur_hash128)->Name("murmur_hash128")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::murmur_hash128_fixed<24, false>)->Name("murmur_hash128_runtime_len/24");
+BENCHMARK(bench::murmur_hash128_fixed<24, true>)->Name("murmur_hash128_static_len/24");
+BENCHMARK(bench::murmur_hash128_fixed<64, false>)->Name("murmur_hash128_runtime_len/64");
+BENCHMARK(bench::murmur_hash128_fixed<64, true>)->Name("murmur_hash128_static_len/64");
+BENCHMARK(bench::murmur_hash_many_isa<dg::cpu_dispatch::Isa::scalar>)->Name("murmur_hash_many/scalar")->Arg(64);
+BENCHMARK(bench::murmur_hash_many_isa<dg::cpu_dispatch::Isa::avx2>)->Name("murmur_hash_many/avx2")->Arg(64);
+BENCHMARK(bench::murmur_hash_many_isa<dg::cpu_dispatch::Isa::avx512>)->Name("murmur_hash_many/avx512")->Arg(64);
+BENCHMARK(bench::murmur_hash_many<false>)->Name("murmur_hash_loop")->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(bench::murmur_hash_many<true>)->Name("murmur_hash_many")->Arg(16)->Arg(64)->Arg(256);
+
+BENCHMARK(bench::serializer_size)->Name("serializer_size")->Arg(16)->Arg(1024)->Arg(65536);
+BENCHMARK(bench::serializer_serialize_string)->Name("serializer_serialize_string")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::serializer_deserialize_string<false>)->Name("serializer_deserialize_string")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::serializer_deserialize_string<true>)->Name("serializer_deserialize_string_checked")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::serializer_serialize_nested<false>)->Name("serializer_serialize_nested_two_pass")->Arg(16)->Arg(1024)->Arg(65536);
+BENCHMARK(bench::serializer_serialize_nested<true>)->Name("serializer_serialize_nested_one_pass")->Arg(16)->Arg(1024)->Arg(65536);
+BENCHMARK(bench::serializer_deserialize_nested)->Name("serializer_deserialize_nested")->Arg(16)->Arg(1024)->Arg(65536);
+BENCHMARK(bench::serializer_format_serialize<dg::compact_serializer::formats::Fixed>)->Name("format_fixed_serialize")->Arg(4096);
+BENCHMARK(bench::serializer_format_serialize<dg::compact_serializer::formats::VarintLength>)->Name("format_varint_length_serialize")->Arg(4096);
+BENCHMARK(bench::serializer_format_serialize<dg::compact_serializer::formats::Varint>)->Name("format_varint_serialize")->Arg(4096);
+BENCHMARK(bench::serializer_format_deserialize<dg::compact_serializer::formats::Fixed, false>)->Name("format_fixed_deserialize")->Arg(4096);
+BENCHMARK(bench::serializer_format_deserialize<dg::compact_serializer::formats::VarintLength, false>)->Name("format_varint_length_deserialize")->Arg(4096);
+BENCHMARK(bench::serializer_format_deserialize<dg::compact_serializer::formats::Varint, false>)->Name("format_varint_deserialize")->Arg(4096);
+BENCHMARK(bench::serializer_format_deserialize<dg::compact_serializer::formats::Fixed, true>)->Name("format_fixed_deserialize_checked")->Arg(4096);
+BENCHMARK(bench::serializer_format_deserialize<dg::compact_serializer::formats::VarintLength, true>)->Name("format_varint_length_deserialize_checked")->Arg(4096);
+BENCHMARK(bench::serializer_format_deserialize<dg::compact_serializer::formats::Varint, true>)->Name("format_varint_deserialize_checked")->Arg(4096);
+
+BENCHMARK(bench::murmur_encode)->Name("murmur_encode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::murmur_decode)->Name("murmur_decode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::murmur_keyed_encode)->Name("murmur_keyed_encode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::murmur_keyed_decode)->Name("murmur_keyed_decode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::murmur_decode_view)->Name("murmur_decode_view")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::mt19937_encode)->Name("mt19937_encode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::mt19937_decode)->Name("mt19937_decode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::double_encode)->Name("double_encode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::double_decode)->Name("double_decode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::spawn_encode)->Name("spawn_encode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::spawn_decode)->Name("spawn_decode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::spawn_keyed_encode)->Name("spawn_keyed_encode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::spawn_keyed_decode)->Name("spawn_keyed_decode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::spawn_encode_span)->Name("spawn_encode_span")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::philox_encode)->Name("philox_encode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::philox_decode)->Name("philox_decode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_DICT_SIZE);
+BENCHMARK(bench::philox_fill<dg::cpu_dispatch::Isa::scalar>)->Name("philox_fill/scalar");
+BENCHMARK(bench::philox_fill<dg::cpu_dispatch::Isa::sse4>)->Name("philox_fill/sse4");
+BENCHMARK(bench::philox_fill<dg::cpu_dispatch::Isa::avx2>)->Name("philox_fill/avx2");
+BENCHMARK(bench::philox_fill<dg::cpu_dispatch::Isa::avx512>)->Name("philox_fill/avx512");
+BENCHMARK(bench::philox_encode_isa<dg::cpu_dispatch::Isa::scalar>)->Name("philox_encode/scalar")->Arg(256);
+BENCHMARK(bench::philox_encode_isa<dg::cpu_dispatch::Isa::avx512>)->Name("philox_encode/avx512")->Arg(256);
+BENCHMARK(bench::philox_decode_parallel)->Name("philox_decode_parallel")->Apply(bench::parallel_decode_args)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bench::philox_decode_range)->Name("philox_decode_range")->Args({1 << 20, 16})->Args({1 << 20, 4096});
+BENCHMARK(bench::byte_shuffle<dg::cpu_dispatch::Isa::scalar>)->Name("byte_shuffle/scalar")->Arg(4096);
+BENCHMARK(bench::byte_shuffle<dg::cpu_dispatch::Isa::avx2>)->Name("byte_shuffle/avx2")->Arg(4096);
+BENCHMARK(bench::byte_shuffle<dg::cpu_dispatch::Isa::avx512>)->Name("byte_shuffle/avx512")->Arg(4096);
+BENCHMARK(bench::block_permutation_encode<dg::cpu_dispatch::Isa::scalar>)->Name("block_permutation_encode/scalar")->Args({1 << 20, 1 << 12})->Args({1 << 20, 1 << 16});
+BENCHMARK(bench::block_permutation_encode<dg::cpu_dispatch::Isa::avx2>)->Name("block_permutation_encode/avx2")->Args({1 << 20, 1 << 12})->Args({1 << 20, 1 << 16});
+BENCHMARK(bench::block_permutation_encode<dg::cpu_dispatch::Isa::avx512>)->Name("block_permutation_encode/avx512")->Args({1 << 20, 1 << 12})->Args({1 << 20, 1 << 16});
+BENCHMARK(bench::block_permutation_decode<dg::cpu_dispatch::Isa::scalar>)->Name("block_permutation_decode/scalar")->Args({1 << 20, 1 << 12})->Args({1 << 20, 1 << 16});
+BENCHMARK(bench::block_permutation_decode<dg::cpu_dispatch::Isa::avx2>)->Name("block_permutation_decode/avx2")->Args({1 << 20, 1 << 12})->Args({1 << 20, 1 << 16});
+BENCHMARK(bench::block_permutation_decode<dg::cpu_dispatch::Isa::avx512>)->Name("block_permutation_decode/avx512")->Args({1 << 20, 1 << 12})->Args({1 << 20, 1 << 16});
+BENCHMARK(bench::spawn_block_encode)->Name("spawn_block_encode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::spawn_block_decode)->Name("spawn_block_decode")->RangeMultiplier(bench::SIZE_MULTIPLIER)->Range(bench::MIN_SIZE, bench::MAX_SIZE);
+BENCHMARK(bench::segmented_encode<false>)->Name("segmented_encode")->Apply(bench::segmented_args<(1 << 20)>)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bench::segmented_decode<false>)->Name("segmented_decode")->Apply(bench::segmented_args<(1 << 20)>)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bench::segmented_encode<true>)->Name("segmented_weak_block_constant_encode")->Apply(bench::segmented_args<(1 << 26)>)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bench::segmented_decode<true>)->Name("segmented_weak_block_constant_decode")->Apply(bench::segmented_args<(1 << 26)>)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bench::versioned_encode<dg::ud_sym_encoder::constants::MT19937_FORMAT>)->Name("versioned_mt19937_encode")->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(bench::versioned_encode<dg::ud_sym_encoder::constants::PHILOX_FORMAT>)->Name("versioned_philox_encode")->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(bench::versioned_decode<dg::ud_sym_encoder::constants::MT19937_FORMAT>)->Name("versioned_mt19937_decode")->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(bench::versioned_decode<dg::ud_sym_encoder::constants::PHILOX_FORMAT>)->Name("versioned_philox_decode")->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(bench::spawn_encode_concurrent)->Name("spawn_encode_concurrent")->Arg(256)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(bench::spawn_encode_many<false>)->Name("spawn_encode_loop")->Arg(16)->Arg(64);
+BENCHMARK(bench::spawn_encode_many<true>)->Name("spawn_encode_batch")->Arg(16)->Arg(64);
+BENCHMARK(bench::spawn_decode_many<false>)->Name("spawn_decode_loop")->Arg(16)->Arg(64);
+BENCHMARK(bench::spawn_decode_many<true>)->Name("spawn_decode_batch")->Arg(16)->Arg(64);
+BENCHMARK(bench::spawn_decode_nested<false>)->Name("spawn_decode_nested_default_alloc")->Arg(16)->Arg(256);
+BENCHMARK(bench::spawn_decode_nested<true>)->Name("spawn_decode_nested_arena")->Arg(16)->Arg(256);
+
+BENCHMARK(bench::byte_dict<true>)->Name("byte_dict_legacy")->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(bench::byte_dict<false>)->Name("byte_dict_engine")->Arg(16)->Arg(256)->Arg(4096);
+
+BENCHMARK_MAIN();
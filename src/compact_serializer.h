@@ -8,11 +8,15 @@
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <cstddef>
 #include <cstring>
 #include <climits>
 #include <bit>
 #include <optional>
 #include <numeric>
+#include <string_view>
+#include <span>
+#include <utility>
 #include "hasher.h"
 #include <type_traits>
 #include <array>
@@ -28,6 +32,29 @@ namespace dg::compact_serializer::types{
     using size_type     = uint64_t;
 }
 
+namespace dg::compact_serializer::formats{
+
+    //compile-time wire format flag - version names the format to whatever frames the bytes, the serializer itself does not write it
+
+    struct Fixed{           //v1 (default) - 8-byte length prefixes, fixed-width integers
+        static constexpr uint8_t version        = 1u;
+        static constexpr bool varint_length     = false;
+        static constexpr bool varint_integer    = false;
+    };
+
+    struct VarintLength{    //v2 - LEB128 length prefixes, fixed-width integers
+        static constexpr uint8_t version        = 2u;
+        static constexpr bool varint_length     = true;
+        static constexpr bool varint_integer    = false;
+    };
+
+    struct Varint{          //v3 - LEB128 length prefixes, LEB128 integers wider than a byte (zigzag for signed), floats stay fixed-width
+        static constexpr uint8_t version        = 3u;
+        static constexpr bool varint_length     = true;
+        static constexpr bool varint_integer    = true;
+    };
+}
+
 namespace dg::compact_serializer::types_space{
 
     static constexpr auto nil_lambda    = [](...){}; 
@@ -160,6 +187,43 @@ namespace dg::compact_serializer::types_space{
     
     template <class T>
     static constexpr bool is_dg_arithmetic_v    = is_dg_arithmetic<T>::value;
+
+    //contiguous containers of arithmetic elements - serialized with one bulk copy, wire format unchanged (std::vector<bool> is not contiguous)
+    template <class T, class = void>
+    struct is_bulk_container: std::false_type{};
+
+    template <class T>
+    struct is_bulk_container<T, std::void_t<std::enable_if_t<std::disjunction_v<is_vector<T>, is_basic_string<T>>>>>: std::bool_constant<is_dg_arithmetic_v<containee_t<T>> && !std::is_same_v<containee_t<T>, bool>>{};
+
+    template <class T>
+    static constexpr bool is_bulk_container_v   = is_bulk_container<T>::value;
+
+    template <class T, class = void>
+    struct is_reservable: std::false_type{};
+
+    template <class T>
+    struct is_reservable<T, std::void_t<decltype(std::declval<T&>().reserve(size_t{}))>>: std::true_type{};
+
+    template <class T>
+    static constexpr bool is_reservable_v       = is_reservable<T>::value;
+
+    //non-owning views - same wire format as std::basic_string / std::vector of the element, deserialized by pointing into the source buffer
+    //spans are restricted to byte-sized elements (std::byte included): the buffer carries no alignment and the bytes are never swapped
+
+    template <class T>
+    struct is_basic_string_view: std::false_type{};
+
+    template <class ...Args>
+    struct is_basic_string_view<std::basic_string_view<Args...>>: std::bool_constant<sizeof(typename std::basic_string_view<Args...>::value_type) == 1u>{};
+
+    template <class T>
+    struct is_byte_span: std::false_type{};
+
+    template <class T>
+    struct is_byte_span<std::span<const T, std::dynamic_extent>>: std::bool_constant<(is_dg_arithmetic_v<T> && sizeof(T) == 1u && !std::is_same_v<T, bool>) || std::is_same_v<T, std::byte>>{};
+
+    template <class T>
+    static constexpr bool is_view_v             = std::disjunction_v<is_basic_string_view<T>, is_byte_span<T>>;
 }
 
 namespace dg::compact_serializer::utility{
@@ -214,9 +278,42 @@ namespace dg::compact_serializer::utility{
 
             return rs;
         }
+
+        //contiguous runs - one memcpy when the byte order already matches, a plain bswap loop (left for the compiler to vectorize) otherwise
+        template <class T, std::enable_if_t<std::is_arithmetic_v<T>, bool> = true>
+        static inline void dump_many(void * dst, const T * src, size_t sz) noexcept{
+
+            if constexpr(std::endian::native == deflt || sizeof(T) == 1u){
+                if (sz != 0u){
+                    std::memcpy(dst, src, sz * sizeof(T));
+                }
+            } else{
+                char * cdst = static_cast<char *>(dst);
+
+                for (size_t i = 0u; i < sz; ++i){
+                    dump(cdst + i * sizeof(T), src[i]);
+                }
+            }
+        }
+
+        template <class T, std::enable_if_t<std::is_arithmetic_v<T>, bool> = true>
+        static inline void load_many(T * dst, const void * src, size_t sz) noexcept{
+
+            if constexpr(std::endian::native == deflt || sizeof(T) == 1u){
+                if (sz != 0u){
+                    std::memcpy(dst, src, sz * sizeof(T));
+                }
+            } else{
+                const char * csrc = static_cast<const char *>(src);
+
+                for (size_t i = 0u; i < sz; ++i){
+                    dst[i] = load<T>(csrc + i * sizeof(T));
+                }
+            }
+        }
     };
 
-    auto hash(const char * buf, size_t sz) noexcept -> hash_type{
+    inline auto hash(const char * buf, size_t sz) noexcept -> hash_type{
         
         static_assert(std::is_same_v<hash_type, size_t>); //stricter req for now
         return dg::hasher::hash_bytes(buf, sz);
@@ -247,8 +344,448 @@ namespace dg::compact_serializer::utility{
     }
 }
 
+namespace dg::compact_serializer::utility{
+
+    template <class Buf>
+    static constexpr bool is_raw_buffer_v = std::is_same_v<Buf, char *>;
+
+    inline auto acquire(char *& buf, size_t sz) noexcept -> char *{
+
+        char * rs = buf;
+        std::advance(buf, sz);
+
+        return rs;
+    }
+
+    template <class Sink, std::enable_if_t<!is_raw_buffer_v<Sink>, bool> = true>
+    inline auto acquire(Sink& sink, size_t sz) -> char *{
+
+        return sink.acquire(sz);
+    }
+
+    //appends to a std::string, growing it geometrically - pointers handed out by acquire() are valid until the next acquire()
+    //nothing points into buf until the first acquire() (which always grows), so buf may be reserved / reallocated after construction - not once writing started
+
+    class GrowableSink{
+
+        private:
+
+            std::string& buf;
+            size_t offset;
+            char * cur;
+            char * last;
+
+        public:
+
+            GrowableSink(std::string& buf) noexcept: buf(buf), offset(buf.size()), cur(nullptr), last(nullptr){}
+
+            auto acquire(size_t n) -> char *{
+
+                if (static_cast<size_t>(std::distance(this->cur, this->last)) < n) [[unlikely]]{
+                    this->grow(n);
+                }
+
+                char * rs = this->cur;
+                std::advance(this->cur, n);
+
+                return rs;
+            }
+
+            auto size() const noexcept -> size_t{
+
+                if (this->cur == nullptr){
+                    return this->offset;
+                }
+
+                return std::distance(static_cast<const char *>(this->buf.data()), static_cast<const char *>(this->cur));
+            }
+
+            void finish(){
+
+                this->buf.resize(this->size());
+            }
+
+        private:
+
+            //fills the spare capacity before reallocating - a reserve(size() + static_size<T>()) ahead of the first acquire() means no allocation at all
+            void grow(size_t n){
+
+                size_t sz       = this->size();
+                size_t new_sz   = std::max(std::max(this->buf.size() * 2, sz + n), size_t{64});
+
+                if (sz + n <= this->buf.capacity()){
+                    new_sz = std::min(new_sz, this->buf.capacity());
+                }
+
+                this->buf.resize(new_sz);
+                this->cur   = this->buf.data() + sz;
+                this->last  = this->buf.data() + this->buf.size();
+            }
+    };
+
+    //caller-provided [first, last) - throws buffer_overflow on the first write that does not fit, nothing past last is touched
+    struct buffer_overflow: std::exception{};
+
+    class BoundedSink{
+
+        private:
+
+            char * first;
+            char * last;
+
+        public:
+
+            BoundedSink(char * first, char * last) noexcept: first(first), last(last){}
+
+            auto acquire(size_t n) -> char *{
+
+                if (static_cast<size_t>(std::distance(this->first, this->last)) < n){
+                    throw buffer_overflow();
+                }
+
+                char * rs = this->first;
+                std::advance(this->first, n);
+
+                return rs;
+            }
+
+            auto current() const noexcept -> char *{
+
+                return this->first;
+            }
+    };
+
+    //Src is either a raw const char * (trusted, caller vouches for the lengths) or utility::BoundedSource (untrusted [first, last) + DecodeLimits)
+
+    struct bad_encoding_format: std::exception{};
+
+    //max_allocation caps the bytes reserved by container/unique_ptr decodes of one object (sizeof(elem) per element, node overhead not included)
+    struct DecodeLimits{
+        size_t max_allocation = size_t{1} << 26;
+    };
+
+    template <class Src>
+    static constexpr bool is_raw_source_v = std::is_same_v<Src, const char *>;
+
+    inline auto consume(const char *& buf, size_t sz) noexcept -> const char *{
+
+        const char * rs = buf;
+        std::advance(buf, sz);
+
+        return rs;
+    }
+
+    template <class Src, std::enable_if_t<!is_raw_source_v<Src>, bool> = true>
+    inline auto consume(Src& src, size_t sz) -> const char *{
+
+        return src.consume(sz);
+    }
+
+    inline void claim(const char *&, size_t, size_t, size_t) noexcept{}
+
+    template <class Src, std::enable_if_t<!is_raw_source_v<Src>, bool> = true>
+    inline void claim(Src& src, size_t sz, size_t elem_wire_sz, size_t elem_alloc_sz){
+
+        src.claim(sz, elem_wire_sz, elem_alloc_sz);
+    }
+
+    inline void expect(const char *&, bool) noexcept{}
+
+    template <class Src, std::enable_if_t<!is_raw_source_v<Src>, bool> = true>
+    inline void expect(Src& src, bool cond){
+
+        src.expect(cond);
+    }
+
+    //every length is validated before anything is reserved or read - a bad length prefix is rejected without touching the bytes behind it
+    class BoundedSource{
+
+        private:
+
+            const char * first;
+            const char * last;
+            size_t budget;
+
+        public:
+
+            BoundedSource(const char * first, const char * last, DecodeLimits limits) noexcept: first(first), last(last), budget(limits.max_allocation){}
+
+            auto consume(size_t n) -> const char *{
+
+                this->expect(n <= this->remaining());
+
+                const char * rs = this->first;
+                std::advance(this->first, n);
+
+                return rs;
+            }
+
+            //sz elements, each at least elem_wire_sz bytes on the wire and elem_alloc_sz bytes in memory
+            void claim(size_t sz, size_t elem_wire_sz, size_t elem_alloc_sz){
+
+                if (elem_wire_sz != 0u){
+                    this->expect(sz <= this->remaining() / elem_wire_sz);
+                }
+
+                if (elem_alloc_sz != 0u){
+                    this->expect(sz <= this->budget / elem_alloc_sz);
+                    this->budget -= sz * elem_alloc_sz;
+                }
+            }
+
+            void expect(bool cond){
+
+                if (!cond){
+                    throw bad_encoding_format();
+                }
+            }
+
+            auto remaining() const noexcept -> size_t{
+
+                return std::distance(this->first, this->last);
+            }
+
+            auto current() const noexcept -> const char *{
+
+                return this->first;
+            }
+    };
+
+    //the bytes of a fixed-size object, bounds-checked once by the source they came from - consume() is a pointer bump, expect() still validates (bool bytes)
+    class FixedSource{
+
+        private:
+
+            const char * first;
+
+        public:
+
+            FixedSource(const char * first) noexcept: first(first){}
+
+            auto consume(size_t n) noexcept -> const char *{
+
+                const char * rs = this->first;
+                std::advance(this->first, n);
+
+                return rs;
+            }
+
+            void claim(size_t, size_t, size_t) noexcept{}
+
+            void expect(bool cond){
+
+                if (!cond){
+                    throw bad_encoding_format();
+                }
+            }
+    };
+
+    template <class Src>
+    static constexpr bool is_fixed_source_v = std::is_same_v<Src, FixedSource>;
+
+    //LEB128 - 7 bits per byte, least significant group first, high bit set on every byte but the last
+    struct VarintService{
+
+        static constexpr size_t MAX_SIZE = 10u;
+
+        static constexpr auto size(uint64_t value) noexcept -> size_t{
+
+            return (std::bit_width(value | 1u) + 6u) / 7u;
+        }
+
+        static inline void dump(char * dst, uint64_t value) noexcept{
+
+            while (value >= 0x80u){
+                *dst++  = static_cast<char>(static_cast<uint8_t>(value) | 0x80u);
+                value   >>= 7;
+            }
+
+            *dst = static_cast<char>(value);
+        }
+
+        //a bounded source with 8 readable bytes decodes the (common) <= 8 byte varints branch-free: one word load, the terminator found by ctz, the 7-bit groups packed by SWAR shifts
+        template <class Src>
+        static inline auto load(Src& src) -> uint64_t{
+
+            if constexpr(!is_raw_source_v<Src>){
+                if (src.remaining() >= sizeof(uint64_t)){
+                    uint64_t word   = SyncedEndiannessService::load<uint64_t>(src.current());
+                    uint64_t stop   = ~word & 0x8080808080808080u;
+
+                    if (stop != 0u){
+                        size_t sz = (static_cast<size_t>(std::countr_zero(stop)) >> 3) + 1u;
+                        src.consume(sz);
+                        return pack(sz == sizeof(uint64_t) ? word : word & ((uint64_t{1} << (sz * CHAR_BIT)) - 1u));
+                    }
+                }
+            }
+
+            return load_bytewise(src);
+        }
+
+        template <class Src>
+        static inline auto load_bytewise(Src& src) -> uint64_t{
+
+            uint64_t rs = 0u;
+
+            for (size_t i = 0u; i < MAX_SIZE; ++i){
+                uint8_t byte = static_cast<uint8_t>(*consume(src, 1u));
+                rs |= static_cast<uint64_t>(byte & 0x7Fu) << (i * 7u);
+
+                if ((byte & 0x80u) == 0u){
+                    expect(src, i + 1u != MAX_SIZE || byte <= 1u); //the 10th byte only carries bit 63
+                    return rs;
+                }
+            }
+
+            expect(src, false);
+            return rs;
+        }
+
+        static constexpr auto pack(uint64_t word) noexcept -> uint64_t{
+
+            word &= 0x7F7F7F7F7F7F7F7Fu;
+            word = (word & 0x007F007F007F007Fu) | ((word & 0x7F007F007F007F00u) >> 1);
+            word = (word & 0x00003FFF00003FFFu) | ((word & 0x3FFF00003FFF0000u) >> 2);
+            word = (word & 0x000000000FFFFFFFu) | ((word & 0x0FFFFFFF00000000u) >> 4);
+
+            return word;
+        }
+
+        static constexpr auto zigzag(int64_t value) noexcept -> uint64_t{
+
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        static constexpr auto unzigzag(uint64_t value) noexcept -> int64_t{
+
+            return static_cast<int64_t>((value >> 1) ^ (~(value & 1u) + 1u));
+        }
+    };
+}
+
 namespace dg::compact_serializer::archive{
 
+    //constexpr walk over a value-initialized object - npos as soon as a member's wire size depends on its value (containers, optionals, unique_ptrs)
+    //reflectibles are walked through dg_reflect, which therefore has to be constexpr to qualify
+
+    struct StaticCounter{
+
+        static constexpr size_t npos = std::numeric_limits<size_t>::max(); 
+
+        template <class T>
+        constexpr auto count(const T& data) const noexcept -> size_t{
+
+            using base_type = types_space::base_type_t<T>;
+
+            if constexpr(types_space::is_dg_arithmetic_v<base_type>){
+                return sizeof(base_type);
+            } else if constexpr(types_space::is_tuple_v<base_type>){
+                return [&]<size_t ...IDX>(const std::index_sequence<IDX...>) noexcept{
+                    size_t rs = 0u;
+                    ((rs = StaticCounter::add(rs, StaticCounter{}.count(std::get<IDX>(data)))), ...);
+                    return rs;
+                }(std::make_index_sequence<std::tuple_size_v<base_type>>{});
+            } else if constexpr(types_space::is_reflectible_v<base_type>){
+                size_t rs       = 0u;
+                auto archiver   = [&rs]<class ...Args>(Args&& ...args) noexcept{
+                    ((rs = StaticCounter::add(rs, StaticCounter{}.count(args))), ...);
+                };
+                data.dg_reflect(archiver);
+                return rs;
+            } else{
+                return npos;
+            }
+        }
+
+        static constexpr auto add(size_t lhs, size_t rhs) noexcept -> size_t{
+
+            return (lhs == npos || rhs == npos) ? npos : lhs + rhs;
+        }
+    };
+}
+
+namespace dg::compact_serializer::types_space{
+
+    template <class T, class = void>
+    struct is_fixed_size: std::false_type{};
+
+    template <class T>
+    struct is_fixed_size<T, std::void_t<std::enable_if_t<std::is_default_constructible_v<T> && archive::StaticCounter{}.count(T{}) != archive::StaticCounter::npos>>>: std::true_type{};
+
+    template <class T>
+    static constexpr bool is_fixed_size_v = is_fixed_size<T>::value;
+}
+
+namespace dg::compact_serializer::archive{
+
+    //lower bound of the wire size of any T - how many elements the remaining bytes could possibly hold
+    //reflectibles are walked once through a value-initialized instance, the result is cached
+
+    template <class Format, class T>
+    static constexpr bool is_varint_v = Format::varint_integer && std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) > 1u);
+
+    //fixed-size shortcuts are only valid while integers keep their width
+    template <class Format, class T>
+    static constexpr bool has_static_size_v = !Format::varint_integer && types_space::is_fixed_size_v<T>;
+
+    template <class T>
+    static constexpr auto to_varint(T data) noexcept -> uint64_t{
+
+        if constexpr(std::is_signed_v<T>){
+            return utility::VarintService::zigzag(static_cast<int64_t>(data));
+        } else{
+            return static_cast<uint64_t>(data);
+        }
+    }
+
+    template <class Format>
+    static constexpr auto length_size(size_t sz) noexcept -> size_t{
+
+        if constexpr(Format::varint_length){
+            return utility::VarintService::size(sz);
+        } else{
+            return sizeof(types::size_type);
+        }
+    }
+
+    template <class Format = formats::Fixed>
+    struct MinCounter{
+
+        template <class T>
+        static auto count() -> size_t{
+
+            using base_type = types_space::base_type_t<T>;
+
+            if constexpr(is_varint_v<Format, base_type>){
+                return 1u;
+            } else if constexpr(types_space::is_dg_arithmetic_v<base_type>){
+                return sizeof(base_type);
+            } else if constexpr(types_space::is_container_v<base_type> || types_space::is_view_v<base_type>){
+                return length_size<Format>(0u);
+            } else if constexpr(types_space::is_unique_ptr_v<base_type> || types_space::is_optional_v<base_type>){
+                return sizeof(bool);
+            } else if constexpr(types_space::is_tuple_v<base_type>){
+                return []<size_t ...IDX>(const std::index_sequence<IDX...>){
+                    return (size_t{0} + ... + MinCounter::count<std::tuple_element_t<IDX, base_type>>());
+                }(std::make_index_sequence<std::tuple_size_v<base_type>>{});
+            } else if constexpr(has_static_size_v<Format, base_type>){
+                return std::integral_constant<size_t, StaticCounter{}.count(base_type{})>::value;
+            } else{
+                static const size_t rs = []{
+                    size_t rs       = 0u;
+                    auto archiver   = [&rs]<class ...Args>(Args&& ...args){
+                        ((rs += MinCounter::count<Args>()), ...);
+                    };
+                    base_type{}.dg_reflect(archiver);
+                    return rs;
+                }();
+                return rs;
+            }
+        }
+    };
+
+    template <class Format = formats::Fixed>
     struct Counter{
         
         using Self = Counter;
@@ -256,7 +793,11 @@ namespace dg::compact_serializer::archive{
         template <class T, std::enable_if_t<types_space::is_dg_arithmetic_v<types_space::base_type_t<T>>, bool> = true>
         auto count(T&& data) const noexcept -> size_t{
             
-            return sizeof(types_space::base_type_t<T>);
+            if constexpr(is_varint_v<Format, types_space::base_type_t<T>>){
+                return utility::VarintService::size(to_varint(data));
+            } else{
+                return sizeof(types_space::base_type_t<T>);
+            }
         }
 
         template <class T, std::enable_if_t<types_space::is_unique_ptr_v<types_space::base_type_t<T>>, bool> = true>
@@ -290,6 +831,10 @@ namespace dg::compact_serializer::archive{
             const auto idx_seq  = std::make_index_sequence<std::tuple_size_v<base_type>>{};
             size_t rs           = {};
 
+            if constexpr(has_static_size_v<Format, base_type>){
+                return std::integral_constant<size_t, StaticCounter{}.count(base_type{})>::value;
+            }
+
             [&rs]<size_t ...IDX>(T&& data, const std::index_sequence<IDX...>) noexcept{
                 rs += (Self().count(std::get<IDX>(data)) + ...);
             }(std::forward<T>(data), idx_seq);
@@ -300,7 +845,12 @@ namespace dg::compact_serializer::archive{
         template <class T, std::enable_if_t<types_space::is_container_v<types_space::base_type_t<T>>, bool> = true>
         auto count(T&& data) const noexcept -> size_t{
             
-            size_t rs = this->count(types::size_type{});
+            using elem_type = types_space::containee_t<types_space::base_type_t<T>>;
+            size_t rs       = length_size<Format>(data.size());
+
+            if constexpr(has_static_size_v<Format, elem_type>){
+                return rs + data.size() * std::integral_constant<size_t, StaticCounter{}.count(elem_type{})>::value;
+            }
 
             for (const auto& e: data){
                 rs += this->count(e);
@@ -309,10 +859,22 @@ namespace dg::compact_serializer::archive{
             return rs;
         }
 
+        template <class T, std::enable_if_t<types_space::is_view_v<types_space::base_type_t<T>>, bool> = true>
+        auto count(T&& data) const noexcept -> size_t{
+
+            return length_size<Format>(data.size()) + data.size();
+        }
+
         template <class T, std::enable_if_t<types_space::is_reflectible_v<types_space::base_type_t<T>>, bool> = true>
         auto count(T&& data) const noexcept -> size_t{
 
+            using base_type = types_space::base_type_t<T>;
             size_t rs       = {};
+
+            if constexpr(has_static_size_v<Format, base_type>){
+                return std::integral_constant<size_t, StaticCounter{}.count(base_type{})>::value;
+            }
+
             auto archiver   = [&rs]<class ...Args>(Args&& ...args) noexcept{
                 rs += (Self().count(std::forward<Args>(args)) + ...);
             };
@@ -322,19 +884,25 @@ namespace dg::compact_serializer::archive{
         }
     };
 
+    //Buf is either a raw char * (caller sized the buffer through Counter) or an output sink (utility::GrowableSink, utility::BoundedSink) that hands out space as the traversal goes
+
+    template <class Format = formats::Fixed>
     struct Forward{
         
         using Self = Forward;
 
-        template <class T, std::enable_if_t<types_space::is_dg_arithmetic_v<types_space::base_type_t<T>>, bool> = true>
-        void put(char *& buf, T&& data) const noexcept{
+        template <class Buf, class T, std::enable_if_t<types_space::is_dg_arithmetic_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Buf& buf, T&& data) const noexcept(utility::is_raw_buffer_v<Buf>){
             
-            utility::SyncedEndiannessService::dump(buf, std::forward<T>(data));
-            std::advance(buf, sizeof(types_space::base_type_t<T>));
+            if constexpr(is_varint_v<Format, types_space::base_type_t<T>>){
+                this->put_varint(buf, to_varint(data));
+            } else{
+                utility::SyncedEndiannessService::dump(utility::acquire(buf, sizeof(types_space::base_type_t<T>)), std::forward<T>(data));
+            }
         }
 
-        template <class T, std::enable_if_t<types_space::is_unique_ptr_v<types_space::base_type_t<T>>, bool> = true>
-        void put(char *& buf, T&& data) const noexcept{
+        template <class Buf, class T, std::enable_if_t<types_space::is_unique_ptr_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Buf& buf, T&& data) const noexcept(utility::is_raw_buffer_v<Buf>){
 
             this->put(buf, static_cast<bool>(data));
 
@@ -343,8 +911,8 @@ namespace dg::compact_serializer::archive{
             }
         }
 
-        template <class T, std::enable_if_t<types_space::is_optional_v<types_space::base_type_t<T>>, bool> = true>
-        void put(char *& buf, T&& data) const noexcept{
+        template <class Buf, class T, std::enable_if_t<types_space::is_optional_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Buf& buf, T&& data) const noexcept(utility::is_raw_buffer_v<Buf>){
 
             this->put(buf, static_cast<bool>(data));
 
@@ -353,121 +921,236 @@ namespace dg::compact_serializer::archive{
             }
         }
 
-        template <class T, std::enable_if_t<types_space::is_tuple_v<types_space::base_type_t<T>>, bool> = true>
-        void put(char *& buf, T&& data) const noexcept{
+        template <class Buf, class T, std::enable_if_t<types_space::is_tuple_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Buf& buf, T&& data) const noexcept(utility::is_raw_buffer_v<Buf>){
 
             using base_type     = types_space::base_type_t<T>;
             const auto idx_seq  = std::make_index_sequence<std::tuple_size_v<base_type>>{};
 
-            []<size_t ...IDX>(char *& buf, T&& data, const std::index_sequence<IDX...>) noexcept{
-                (Self().put(buf, std::get<IDX>(data)), ...);
-            }(buf, std::forward<T>(data), idx_seq);
+            if constexpr(has_static_size_v<Format, base_type> && !utility::is_raw_buffer_v<Buf>){
+                this->put_fixed(buf, std::forward<T>(data));
+            } else{
+                []<size_t ...IDX>(Buf& buf, T&& data, const std::index_sequence<IDX...>) noexcept(utility::is_raw_buffer_v<Buf>){
+                    (Self().put(buf, std::get<IDX>(data)), ...);
+                }(buf, std::forward<T>(data), idx_seq);
+            }
         }
 
-        template <class T, std::enable_if_t<types_space::is_container_v<types_space::base_type_t<T>>, bool> = true>
-        void put(char *& buf, T&& data) const noexcept{
+        template <class Buf, class T, std::enable_if_t<types_space::is_container_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Buf& buf, T&& data) const noexcept(utility::is_raw_buffer_v<Buf>){
             
-            this->put(buf, static_cast<types::size_type>(data.size()));
+            using base_type = types_space::base_type_t<T>;
+            this->put_length(buf, data.size());
 
-            //optimizable - worth or not worth it
-            for (const auto& e: data){
-                this->put(buf, e);
+            if constexpr(types_space::is_bulk_container_v<base_type> && !is_varint_v<Format, types_space::containee_t<base_type>>){
+                using elem_type = types_space::containee_t<base_type>;
+                utility::SyncedEndiannessService::dump_many(utility::acquire(buf, data.size() * sizeof(elem_type)), data.data(), data.size());
+            } else{
+                for (const auto& e: data){
+                    this->put(buf, e);
+                }
             }
         }
 
-        template <class T, std::enable_if_t<types_space::is_reflectible_v<types_space::base_type_t<T>>, bool> = true>
-        void put(char *& buf, T&& data) const noexcept{
+        template <class Buf, class T, std::enable_if_t<types_space::is_view_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Buf& buf, T&& data) const noexcept(utility::is_raw_buffer_v<Buf>){
 
-            auto archiver = [&buf]<class ...Args>(Args&& ...args) noexcept{
-                (Self().put(buf, std::forward<Args>(args)), ...);
-            };
+            this->put_length(buf, data.size());
+            char * dst = utility::acquire(buf, data.size());
 
-            data.dg_reflect(archiver);
+            if (data.size() != 0u){
+                std::memcpy(dst, data.data(), data.size()); //byte-sized elements - std::byte has no endianness service
+            }
+        }
+
+        template <class Buf, class T, std::enable_if_t<types_space::is_reflectible_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Buf& buf, T&& data) const noexcept(utility::is_raw_buffer_v<Buf>){
+
+            if constexpr(has_static_size_v<Format, types_space::base_type_t<T>> && !utility::is_raw_buffer_v<Buf>){
+                this->put_fixed(buf, std::forward<T>(data));
+            } else{
+                auto archiver = [&buf]<class ...Args>(Args&& ...args) noexcept(utility::is_raw_buffer_v<Buf>){
+                    (Self().put(buf, std::forward<Args>(args)), ...);
+                };
+
+                data.dg_reflect(archiver);
+            }
+        }
+
+        //fixed layout - one acquire for the whole object, the fields are stored through the raw pointer path (no per-field sink checks)
+        template <class Buf, class T>
+        void put_fixed(Buf& buf, T&& data) const{
+
+            char * first = utility::acquire(buf, std::integral_constant<size_t, StaticCounter{}.count(types_space::base_type_t<T>{})>::value);
+            this->put(first, std::forward<T>(data));
+        }
+
+        template <class Buf>
+        void put_length(Buf& buf, size_t sz) const noexcept(utility::is_raw_buffer_v<Buf>){
+
+            if constexpr(Format::varint_length){
+                this->put_varint(buf, sz);
+            } else{
+                this->put(buf, static_cast<types::size_type>(sz));
+            }
+        }
+
+        template <class Buf>
+        void put_varint(Buf& buf, uint64_t value) const noexcept(utility::is_raw_buffer_v<Buf>){
+
+            utility::VarintService::dump(utility::acquire(buf, utility::VarintService::size(value)), value);
         }
     };
 
+    template <class Format = formats::Fixed>
     struct Backward{
 
         using Self = Backward;
 
-        template <class T, std::enable_if_t<types_space::is_dg_arithmetic_v<types_space::base_type_t<T>>, bool> = true>
-        void put(const char *& buf, T&& data) const{
+        template <class Src, class T, std::enable_if_t<types_space::is_dg_arithmetic_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Src& src, T&& data) const{
 
             using base_type = types_space::base_type_t<T>;
-            data = utility::SyncedEndiannessService::load<base_type>(buf);
-            std::advance(buf, sizeof(base_type));
+
+            if constexpr(is_varint_v<Format, base_type>){
+                uint64_t value = utility::VarintService::load(src);
+
+                if constexpr(std::is_signed_v<base_type>){
+                    int64_t signed_value = utility::VarintService::unzigzag(value);
+                    utility::expect(src, std::in_range<base_type>(signed_value));
+                    data = static_cast<base_type>(signed_value);
+                } else{
+                    utility::expect(src, std::in_range<base_type>(value));
+                    data = static_cast<base_type>(value);
+                }
+            } else if constexpr(std::is_same_v<base_type, bool>){
+                uint8_t value = utility::SyncedEndiannessService::load<uint8_t>(utility::consume(src, sizeof(uint8_t)));
+                utility::expect(src, value <= 1u);
+                data = static_cast<bool>(value);
+            } else{
+                data = utility::SyncedEndiannessService::load<base_type>(utility::consume(src, sizeof(base_type)));
+            }
         }
 
-        template <class T, std::enable_if_t<types_space::is_unique_ptr_v<types_space::base_type_t<T>>, bool> = true>
-        void put(const char *& buf, T&& data) const{
+        template <class Src, class T, std::enable_if_t<types_space::is_unique_ptr_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Src& src, T&& data) const{
 
             using containee_type = typename types_space::base_type_t<T>::element_type;
             bool status = {};
-            this->put(buf, status);
+            this->put(src, status);
 
             if (status){
+                utility::claim(src, 1u, 0u, sizeof(containee_type));
                 auto obj = containee_type{};
-                this->put(buf, obj);
+                this->put(src, obj);
                 data = std::make_unique<containee_type>(std::move(obj));
             } else{
                 data = nullptr;
             }
         }
 
-        template <class T, std::enable_if_t<types_space::is_optional_v<types_space::base_type_t<T>>, bool> = true>
-        void put(const char *& buf, T&& data) const{
+        template <class Src, class T, std::enable_if_t<types_space::is_optional_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Src& src, T&& data) const{
 
             using containee_type = typename types_space::base_type_t<T>::value_type;
             bool status = {};
-            this->put(buf, status);
+            this->put(src, status);
 
             if (status){
                 auto obj = containee_type{};
-                this->put(buf, obj);
+                this->put(src, obj);
                 data = std::optional<containee_type>(std::in_place_t{}, std::move(obj)); //fine
             } else{
                 data = std::nullopt;
             }
         }
 
-        template <class T, std::enable_if_t<types_space::is_tuple_v<types_space::base_type_t<T>>, bool> = true>
-        void put(const char *& buf, T&& data) const{
+        template <class Src, class T, std::enable_if_t<types_space::is_tuple_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Src& src, T&& data) const{
 
             using base_type     = types_space::base_type_t<T>;
             const auto idx_seq  = std::make_index_sequence<std::tuple_size_v<base_type>>{};
 
-            []<size_t ...IDX>(const char *& buf, T&& data, const std::index_sequence<IDX...>){
-                (Self().put(buf, std::get<IDX>(data)), ...);
-            }(buf, std::forward<T>(data), idx_seq);
+            if constexpr(has_static_size_v<Format, base_type> && !utility::is_raw_source_v<Src> && !utility::is_fixed_source_v<Src>){
+                this->put_fixed(src, std::forward<T>(data));
+            } else{
+                []<size_t ...IDX>(Src& src, T&& data, const std::index_sequence<IDX...>){
+                    (Self().put(src, std::get<IDX>(data)), ...);
+                }(src, std::forward<T>(data), idx_seq);
+            }
         }
 
-        template <class T, std::enable_if_t<types_space::is_container_v<types_space::base_type_t<T>>, bool> = true>
-        void put(const char *& buf, T&& data) const{
+        template <class Src, class T, std::enable_if_t<types_space::is_container_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Src& src, T&& data) const{
             
             using base_type = types_space::base_type_t<T>;
             using elem_type = types_space::containee_t<base_type>;
-            auto sz         = types::size_type{};
             auto isrter     = utility::get_inserter<base_type>();
+            auto sz         = this->get_length(src);
 
-            this->put(buf, sz); 
-            data.reserve(sz);
+            utility::claim(src, sz, MinCounter<Format>::template count<elem_type>(), sizeof(elem_type));
 
-            //optimizable - worth or not worth it
-            for (size_t i = 0; i < sz; ++i){
-                elem_type e{};
-                this->put(buf, e);
-                isrter(data, std::move(e));
+            if constexpr(types_space::is_bulk_container_v<base_type> && !is_varint_v<Format, elem_type>){
+                size_t offset = data.size();
+                data.resize(offset + sz);
+                utility::SyncedEndiannessService::load_many(data.data() + offset, utility::consume(src, sz * sizeof(elem_type)), sz);
+            } else{
+                if constexpr(types_space::is_reservable_v<base_type>){
+                    data.reserve(sz);
+                }
+
+                //uses-allocator construction - elements of std::pmr containers (and both halves of std::pmr map buckets) allocate from the container's resource
+                for (size_t i = 0; i < sz; ++i){
+                    auto e = std::make_obj_using_allocator<elem_type>(data.get_allocator());
+                    this->put(src, e);
+                    isrter(data, std::move(e));
+                }
             }
         }
 
-        template <class T, std::enable_if_t<types_space::is_reflectible_v<types_space::base_type_t<T>>, bool> = true>
-        void put(const char *& buf, T&& data) const{
+        //the view points into the source buffer - valid only as long as the buffer is
+        template <class Src, class T, std::enable_if_t<types_space::is_view_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Src& src, T&& data) const{
 
-            auto archiver = [&buf]<class ...Args>(Args&& ...args){
-                (Self().put(buf, std::forward<Args>(args)), ...);
-            };
+            using base_type = types_space::base_type_t<T>;
+            using elem_type = typename base_type::value_type;
+            auto sz         = this->get_length(src);
 
-            data.dg_reflect(archiver);
+            data = base_type(reinterpret_cast<const elem_type *>(utility::consume(src, sz)), sz);
+        }
+
+        template <class Src, class T, std::enable_if_t<types_space::is_reflectible_v<types_space::base_type_t<T>>, bool> = true>
+        void put(Src& src, T&& data) const{
+
+            if constexpr(has_static_size_v<Format, types_space::base_type_t<T>> && !utility::is_raw_source_v<Src> && !utility::is_fixed_source_v<Src>){
+                this->put_fixed(src, std::forward<T>(data));
+            } else{
+                auto archiver = [&src]<class ...Args>(Args&& ...args){
+                    (Self().put(src, std::forward<Args>(args)), ...);
+                };
+
+                data.dg_reflect(archiver);
+            }
+        }
+
+        //fixed layout - one bounds check for the whole object, the fields are loaded by pointer bumps (bool bytes are still validated)
+        template <class Src, class T>
+        void put_fixed(Src& src, T&& data) const{
+
+            auto fixed_src = utility::FixedSource(utility::consume(src, std::integral_constant<size_t, StaticCounter{}.count(types_space::base_type_t<T>{})>::value));
+            this->put(fixed_src, std::forward<T>(data));
+        }
+
+        template <class Src>
+        auto get_length(Src& src) const -> types::size_type{
+
+            if constexpr(Format::varint_length){
+                return utility::VarintService::load(src);
+            } else{
+                auto sz = types::size_type{};
+                this->put(src, sz);
+                return sz;
+            }
         }
     };
 }
@@ -475,6 +1158,7 @@ namespace dg::compact_serializer::archive{
 namespace dg::compact_serializer{
 
     //defined if: involving types c {std_arithmetic, std::tuple and friends, std::vector, std::unordered_map, std::map, std::unrodered_set, std::set, std::optional, std::basic_string, std::unique_ptr, dg_reflectible}
+    //            + std::basic_string_view / std::span<const byte_sized_arithmetic> - deserialized as views into the source buffer, which must outlive them
     //            involving types - except the ones coerced by internal functions - are base types (no const no reference) 
     
     //a class is dg_reflectible qualified if (1): it's members are dg_reflectible-qualfied - refer to involving types
@@ -484,46 +1168,138 @@ namespace dg::compact_serializer{
 
     //undefined if not in defined
 
-    struct bad_encoding_format: std::exception{}; 
+    using bad_encoding_format   = utility::bad_encoding_format;
+    using buffer_overflow       = utility::buffer_overflow;
+    using DecodeLimits          = utility::DecodeLimits;
 
-    template <class T>
+    //wire size of T known at compile time - T is arithmetic or a tuple / reflectible (constexpr dg_reflect) made only of those
+    //such objects are laid out in one piece - sinks and bounded sources take them with one acquire / one bounds check, the fields then go through the raw pointer path (the raw paths are straight-line already, the traversal is expanded at compile time)
+    template <class T, std::enable_if_t<types_space::is_fixed_size_v<T>, bool> = true>
+    static consteval auto static_size() noexcept -> size_t{
+
+        return archive::StaticCounter{}.count(T{});
+    }
+
+    //Format is a formats:: flag - every call site of one wire must agree on it, formats::Fixed (v1) is the default and the format used by the encoders
+
+    template <class Format = formats::Fixed, class T>
     auto size(const T& obj) noexcept -> size_t{
 
-        return archive::Counter{}.count(obj);
+        if constexpr(archive::has_static_size_v<Format, T>){
+            return static_size<T>();
+        } else{
+            return archive::Counter<Format>{}.count(obj);
+        }
     }
 
-    template <class T>
+    template <class Format = formats::Fixed, class T>
     auto serialize_into(char * buf, const T& obj) noexcept -> char *{
 
-        archive::Forward{}.put(buf, obj);
+        archive::Forward<Format>{}.put(buf, obj);
         return buf;
     } 
 
-    template <class T>
+    //single traversal - no Counter pre-walk, out grows as needed (serialized bytes are appended)
+    template <class Format = formats::Fixed, class T>
+    void serialize_into(std::string& out, const T& obj){
+
+        if constexpr(archive::has_static_size_v<Format, T>){
+            out.reserve(out.size() + static_size<T>());
+        }
+
+        auto sink = utility::GrowableSink(out);
+
+        archive::Forward<Format>{}.put(sink, obj);
+        sink.finish();
+    }
+
+    template <class Format = formats::Fixed, class T>
+    auto serialize(const T& obj) -> std::string{
+
+        std::string rs{};
+        serialize_into<Format>(rs, obj);
+
+        return rs;
+    }
+
+    //bounded - throws utility::buffer_overflow as soon as [first, last) runs out, returns the end of the written range
+    template <class Format = formats::Fixed, class T>
+    auto serialize_into(char * first, char * last, const T& obj) -> char *{
+
+        auto sink = utility::BoundedSink(first, last);
+        archive::Forward<Format>{}.put(sink, obj);
+
+        return sink.current();
+    }
+
+    template <class Format = formats::Fixed, class T>
     auto deserialize_into(T& obj, const char * buf) -> const char *{
 
-        archive::Backward().put(buf, obj);
+        archive::Backward<Format>().put(buf, obj);
         return buf;
     }
 
-    template <class T>
+    //untrusted [first, last) - throws bad_encoding_format on the first length that overruns last or the allocation budget, returns the end of the consumed range
+    template <class Format = formats::Fixed, class T>
+    auto deserialize_into(T& obj, const char * first, const char * last, DecodeLimits limits = {}) -> const char *{
+
+        auto src = utility::BoundedSource(first, last, limits);
+        archive::Backward<Format>{}.put(src, obj);
+
+        return src.current();
+    }
+
+    //the integrity hash trailer is always a fixed-width hash_type, whatever Format the payload uses
+
+    template <class Format = formats::Fixed, class T>
     auto integrity_size(const T& obj) noexcept -> size_t{
 
-        return size(obj) + size(types::hash_type{});
+        return size<Format>(obj) + size(types::hash_type{});
     }
 
-    template <class T>
+    template <class Format = formats::Fixed, class T>
     auto integrity_serialize_into(char * buf, const T& obj) noexcept -> char *{ 
         
         char * first                = buf;
-        char * last                 = serialize_into(first, obj);
-        types::hash_type hashed     = utility::hash(first, std::distance(first, last));
+        char * last                 = serialize_into<Format>(first, obj);
+        types::hash_type hashed     = {};
+
+        if constexpr(archive::has_static_size_v<Format, T>){
+            hashed = dg::hasher::hash_bytes(first, std::integral_constant<size_t, static_size<T>()>{});
+        } else{
+            hashed = utility::hash(first, std::distance(first, last));
+        }
+
         char * llast                = serialize_into(last, hashed);
 
         return llast;
     }
 
-    template <class T>
+    template <class Format = formats::Fixed, class T>
+    void integrity_serialize_into(std::string& out, const T& obj){
+
+        size_t first = out.size();
+        serialize_into<Format>(out, obj);
+        serialize_into(out, utility::hash(out.data() + first, out.size() - first));
+    }
+
+    template <class Format = formats::Fixed, class T>
+    auto integrity_serialize(const T& obj) -> std::string{
+
+        std::string rs{};
+        integrity_serialize_into<Format>(rs, obj);
+
+        return rs;
+    }
+
+    template <class Format = formats::Fixed, class T>
+    auto integrity_serialize_into(char * first, char * last, const T& obj) -> char *{
+
+        char * llast = serialize_into<Format>(first, last, obj);
+        return serialize_into(llast, last, utility::hash(first, std::distance(first, llast)));
+    }
+
+    template <class Format = formats::Fixed, class T>
     void integrity_deserialize_into(T& obj, const char * buf, size_t sz){
 
         if (sz < size(types::hash_type{})){
@@ -533,14 +1309,49 @@ namespace dg::compact_serializer{
         const char * first          = buf;
         const char * last           = first + (sz - size(types::hash_type{})); 
         types::hash_type expected   = {};
-        types::hash_type reality    = utility::hash(first, std::distance(first, last));
+        types::hash_type reality    = {};
+
+        //the compile-time-length hash only for the exact frame size - other sizes keep the runtime-length path (same acceptance as for any other T)
+        if constexpr(archive::has_static_size_v<Format, T>){
+            if (sz == static_size<T>() + static_size<types::hash_type>()){
+                reality = dg::hasher::hash_bytes(first, std::integral_constant<size_t, static_size<T>()>{});
+            } else{
+                reality = utility::hash(first, std::distance(first, last));
+            }
+        } else{
+            reality = utility::hash(first, std::distance(first, last));
+        }
+
         deserialize_into(expected, last);
 
         if (expected != reality){
             throw bad_encoding_format();
         }
 
-        deserialize_into(obj, first);
+        deserialize_into<Format>(obj, first);
+    }
+
+    //checked counterpart - lengths are validated (and the payload must be consumed exactly) before the integrity hash is paid for
+    template <class Format = formats::Fixed, class T>
+    void integrity_deserialize_into(T& obj, const char * buf, size_t sz, DecodeLimits limits){
+
+        if (sz < size(types::hash_type{})){
+            throw bad_encoding_format();
+        }
+
+        const char * first          = buf;
+        const char * last           = first + (sz - size(types::hash_type{}));
+        types::hash_type expected   = {};
+
+        if (deserialize_into<Format>(obj, first, last, limits) != last){
+            throw bad_encoding_format();
+        }
+
+        deserialize_into(expected, last);
+
+        if (expected != utility::hash(first, std::distance(first, last))){
+            throw bad_encoding_format();
+        }
     }
 }
 
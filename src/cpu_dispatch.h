@@ -0,0 +1,143 @@
+#ifndef __DG_CPU_DISPATCH_H__
+#define __DG_CPU_DISPATCH_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <exception>
+#include <string_view>
+
+//SIMD kernels are compiled with per-function target attributes (no -march needed) and picked at runtime - one binary for the whole fleet
+//kernels with a path for the active isa use it, the others fall back to the widest path they have below it
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define DG_CPU_DISPATCH_X86 1
+#include <immintrin.h>
+#else
+#define DG_CPU_DISPATCH_X86 0
+#endif
+
+namespace dg::cpu_dispatch{
+
+    enum class Isa: uint8_t{
+        scalar  = 0,
+        sse4    = 1, //SSE4.1
+        avx2    = 2,
+        avx512  = 3  //AVX512F + DQ + BW
+    };
+
+    //DG_UD_SYM_ISA=scalar|sse4|avx2|avx512 caps the path picked at startup - unknown values are ignored, values above the cpu are clamped to it
+    static constexpr const char * ISA_ENV = "DG_UD_SYM_ISA";
+
+    struct invalid_argument: std::exception{};
+
+    static constexpr auto to_string(Isa isa) noexcept -> std::string_view{
+
+        switch (isa){
+            case Isa::scalar:   return "scalar";
+            case Isa::sse4:     return "sse4";
+            case Isa::avx2:     return "avx2";
+            case Isa::avx512:   return "avx512";
+            default:            return "unknown";
+        }
+    }
+
+    static constexpr auto isa_from_string(std::string_view name) noexcept -> std::optional<Isa>{
+
+        for (Isa isa: {Isa::scalar, Isa::sse4, Isa::avx2, Isa::avx512}){
+            if (to_string(isa) == name){
+                return isa;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    static inline auto detect_isa() noexcept -> Isa{
+
+#if DG_CPU_DISPATCH_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512bw")){
+            return Isa::avx512;
+        }
+
+        if (__builtin_cpu_supports("avx2")){
+            return Isa::avx2;
+        }
+
+        if (__builtin_cpu_supports("sse4.1")){
+            return Isa::sse4;
+        }
+#endif
+
+        return Isa::scalar;
+    }
+
+    static inline auto startup_isa() noexcept -> Isa{
+
+        Isa detected        = detect_isa();
+        const char * env    = getenv(ISA_ENV);
+
+        if (env == nullptr){
+            return detected;
+        }
+
+        std::optional<Isa> requested = isa_from_string(env);
+
+        if (!requested.has_value()){
+            return detected;
+        }
+
+        return std::min(requested.value(), detected);
+    }
+
+    //inline (not static) - one selection shared by every translation unit
+    inline auto isa_state() noexcept -> std::atomic<Isa>&{
+
+        static std::atomic<Isa> state(startup_isa());
+        return state;
+    }
+
+    static inline auto active_isa() noexcept -> Isa{
+
+        return isa_state().load(std::memory_order_relaxed);
+    }
+
+    //API override - throws invalid_argument if the cpu does not support isa, kernels already running finish on the previous path
+    static inline void set_isa(Isa isa){
+
+        if (isa > detect_isa()){
+            throw invalid_argument();
+        }
+
+        isa_state().store(isa, std::memory_order_relaxed);
+    }
+
+    //extensions on top of an isa level - kernels check the level through active_isa() first, so DG_UD_SYM_ISA / set_isa still cap them
+    static inline auto detect_avx512_vbmi() noexcept -> bool{
+
+#if DG_CPU_DISPATCH_X86
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512vbmi");
+#else
+        return false;
+#endif
+    }
+
+    inline auto has_avx512_vbmi() noexcept -> bool{
+
+        static const bool rs = detect_avx512_vbmi();
+        return rs;
+    }
+
+    //back to the startup selection (DG_UD_SYM_ISA, then detection)
+    static inline void reset_isa() noexcept{
+
+        isa_state().store(startup_isa(), std::memory_order_relaxed);
+    }
+}
+
+#endif
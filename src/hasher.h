@@ -2,9 +2,14 @@
 #define __DG_HASHER_H__
 
 #include "trivial_serializer.h"
+#include "cpu_dispatch.h"
 #include <stdint.h>
 #include <stdlib.h>
 #include <bit>
+#include <array>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 
 namespace dg::hasher{
 
@@ -24,31 +29,27 @@ namespace dg::hasher{
         return k;
     }
 
-    static constexpr auto murmur_hash(const char * buf, size_t len, const uint32_t seed = 0xFF) -> uint64_t{
-    
-        const size_t nblocks = len / 16;
-
-        uint64_t h1 = seed;
-        uint64_t h2 = seed;
+    static constexpr void murmur_block(uint64_t& h1, uint64_t& h2, const char * buf) noexcept{
 
         const uint64_t c1 = 0x87c37b91114253d5;
         const uint64_t c2 = 0x4cf5ad432745937f;
 
-        for(size_t i = 0; i < nblocks; i++)
-        {   
-            uint64_t k1{};
-            uint64_t k2{};
+        uint64_t k1{};
+        uint64_t k2{};
 
-            dg::trivial_serializer::deserialize_into(k1, buf + (i * 2 + 0) * sizeof(uint64_t));
-            dg::trivial_serializer::deserialize_into(k2, buf + (i * 2 + 1) * sizeof(uint64_t));
+        dg::trivial_serializer::deserialize_into(k1, buf);
+        dg::trivial_serializer::deserialize_into(k2, buf + sizeof(uint64_t));
 
-            k1 *= c1; k1  = rotl64(k1,31); k1 *= c2; h1 ^= k1;
-            h1 = rotl64(h1,27); h1 += h2; h1 = h1*5+0x52dce729;
-            k2 *= c2; k2  = rotl64(k2,33); k2 *= c1; h2 ^= k2;
-            h2 = rotl64(h2,31); h2 += h1; h2 = h2*5+0x38495ab5;
-        }
+        k1 *= c1; k1  = rotl64(k1,31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1,27); h1 += h2; h1 = h1*5+0x52dce729;
+        k2 *= c2; k2  = rotl64(k2,33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2,31); h2 += h1; h2 = h2*5+0x38495ab5;
+    }
 
-        const char * tail = buf + nblocks*16;
+    static constexpr void murmur_tail(uint64_t& h1, uint64_t& h2, const char * tail, size_t len) noexcept{
+
+        const uint64_t c1 = 0x87c37b91114253d5;
+        const uint64_t c2 = 0x4cf5ad432745937f;
 
         uint64_t k1 = 0;
         uint64_t k2 = 0;
@@ -74,6 +75,12 @@ namespace dg::hasher{
             case  1: k1 ^= static_cast<uint64_t>(std::bit_cast<uint8_t>(tail[0])) << 0;
                     k1 *= c1; k1  = rotl64(k1,31); k1 *= c2; h1 ^= k1;
         };
+    }
+
+    //{h1, h2} - the full MurmurHash3_x64_128 digest, h1 is the low half (first 8 bytes of the reference output)
+    using hash128_type = std::array<uint64_t, 2>;
+
+    static constexpr auto murmur_finalize128(uint64_t h1, uint64_t h2, size_t len) noexcept -> hash128_type{
 
         h1 ^= static_cast<uint64_t>(len); 
         h2 ^= static_cast<uint64_t>(len);
@@ -87,9 +94,112 @@ namespace dg::hasher{
         h1 += h2;
         h2 += h1;
 
-        return h1;
+        return {h1, h2};
+    }
+
+    static constexpr auto murmur_finalize(uint64_t h1, uint64_t h2, size_t len) noexcept -> uint64_t{
+
+        return murmur_finalize128(h1, h2, len)[0];
+    }
+
+    static constexpr auto murmur_hash(const char * buf, size_t len, const uint32_t seed = 0xFF) -> uint64_t{
+    
+        const size_t nblocks = len / 16;
+
+        uint64_t h1 = seed;
+        uint64_t h2 = seed;
+
+        for(size_t i = 0; i < nblocks; i++)
+        {   
+            murmur_block(h1, h2, buf + i * 16);
+        }
+
+        murmur_tail(h1, h2, buf + nblocks * 16, len);
+
+        return murmur_finalize(h1, h2, len);
     }
 
+    //seed is not narrowed - h1 = h2 = seed, so seeds < 2^32 give the reference MurmurHash3_x64_128 digest and murmur_hash128(buf, len, seed)[0] == murmur_hash(buf, len, seed)
+    static constexpr auto murmur_hash128(const char * buf, size_t len, const uint64_t seed = 0xFF) noexcept -> hash128_type{
+
+        const size_t nblocks = len / 16;
+
+        uint64_t h1 = seed;
+        uint64_t h2 = seed;
+
+        for (size_t i = 0; i < nblocks; ++i){
+            murmur_block(h1, h2, buf + i * 16);
+        }
+
+        murmur_tail(h1, h2, buf + nblocks * 16, len);
+
+        return murmur_finalize128(h1, h2, len);
+    }
+
+    //murmur_hash(buf, len, seed) fed in arbitrary chunks - the < 16 byte block remainder is carried across update() calls, finalize() gives the same digest as the one-shot function over the concatenation
+    //copyable - absorb a common prefix once, copy the state per suffix
+
+    class MurmurState{
+
+        private:
+
+            uint64_t h1;
+            uint64_t h2;
+            size_t len;
+            std::array<char, 16> block;
+
+        public:
+
+            //seed is not narrowed (murmur_hash128) - pass a uint32_t to get the murmur_hash digest of a 64-bit secret
+            constexpr MurmurState(const uint64_t seed = 0xFF) noexcept: h1(seed), h2(seed), len(0u), block(){}
+
+            constexpr void update(const char * buf, size_t sz) noexcept{
+
+                size_t block_sz = this->len & 15;
+                this->len       += sz;
+
+                if (block_sz != 0u){
+                    size_t fill_sz = std::min(sz, this->block.size() - block_sz);
+
+                    for (size_t i = 0; i < fill_sz; ++i){
+                        this->block[block_sz + i] = buf[i];
+                    }
+
+                    block_sz    += fill_sz;
+                    buf         += fill_sz;
+                    sz          -= fill_sz;
+
+                    if (block_sz != this->block.size()){
+                        return;
+                    }
+
+                    murmur_block(this->h1, this->h2, this->block.data());
+                }
+
+                for (; sz >= 16u; buf += 16, sz -= 16){
+                    murmur_block(this->h1, this->h2, buf);
+                }
+
+                for (size_t i = 0; i < sz; ++i){
+                    this->block[i] = buf[i];
+                }
+            }
+
+            constexpr auto finalize() const noexcept -> uint64_t{
+
+                return this->finalize128()[0];
+            }
+
+            constexpr auto finalize128() const noexcept -> hash128_type{
+
+                uint64_t h1 = this->h1;
+                uint64_t h2 = this->h2;
+                murmur_tail(h1, h2, this->block.data(), this->len & 15);
+
+                return murmur_finalize128(h1, h2, this->len);
+            }
+    };
+
     template <size_t LEN, size_t SEED = 0xFF>
     static constexpr auto murmur_hash(const char * buf, const std::integral_constant<size_t, LEN>, const std::integral_constant<uint64_t, SEED> seed = std::integral_constant<size_t, SEED>{}) -> uint64_t{ //this should be compiler responsibility - yet reimplementation for now (because of compiler limitation)
 
@@ -157,6 +267,226 @@ namespace dg::hasher{
         return h1;
     } 
 
+    //LEN known at compile time - constant trip count for the block loop, the tail switch folds to its one live case
+    template <size_t LEN, uint64_t SEED = 0xFF>
+    static constexpr auto murmur_hash128(const char * buf, const std::integral_constant<size_t, LEN>, const std::integral_constant<uint64_t, SEED> = std::integral_constant<uint64_t, SEED>{}) noexcept -> hash128_type{
+
+        constexpr size_t NBLOCKS = LEN / 16;
+
+        uint64_t h1 = SEED;
+        uint64_t h2 = SEED;
+
+        for (size_t i = 0; i < NBLOCKS; ++i){
+            murmur_block(h1, h2, buf + i * 16);
+        }
+
+        murmur_tail(h1, h2, buf + NBLOCKS * 16, LEN);
+
+        return murmur_finalize128(h1, h2, LEN);
+    }
+
+    //batch murmur_hash - out[i] == murmur_hash(bufs[i], lens[i], seed) bit-for-bit
+    //SIMD paths run LANE_SZ independent hashes side by side over the blocks every lane has, each lane then finishes its own remaining blocks + tail in scalar
+
+    static inline void murmur_absorb_lane(uint64_t& h1, uint64_t& h2, const char * buf, size_t len, size_t absorbed_blocks) noexcept{
+
+        const size_t nblocks = len / 16;
+
+        for (size_t i = absorbed_blocks; i < nblocks; ++i){
+            murmur_block(h1, h2, buf + i * 16);
+        }
+
+        murmur_tail(h1, h2, buf + nblocks * 16, len);
+    }
+
+    static inline void murmur_hash_many_scalar(const char * const * bufs, const size_t * lens, size_t n, const uint32_t seed, uint64_t * out) noexcept{
+
+        for (size_t i = 0; i < n; ++i){
+            out[i] = murmur_hash(bufs[i], lens[i], seed);
+        }
+    }
+
+#if DG_CPU_DISPATCH_X86
+
+    __attribute__((target("avx2"))) static inline auto avx2_mul64(__m256i a, __m256i b) noexcept -> __m256i{
+
+        __m256i lo      = _mm256_mul_epu32(a, b);
+        __m256i cross   = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+
+        return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+    }
+
+    template <int R>
+    __attribute__((target("avx2"))) static inline auto avx2_rotl64(__m256i x) noexcept -> __m256i{
+
+        return _mm256_or_si256(_mm256_slli_epi64(x, R), _mm256_srli_epi64(x, 64 - R));
+    }
+
+    __attribute__((target("avx2"))) static inline auto avx2_fmix64(__m256i k) noexcept -> __m256i{
+
+        k = _mm256_xor_si256(k, _mm256_srli_epi64(k, 33));
+        k = avx2_mul64(k, _mm256_set1_epi64x(0xff51afd7ed558ccd));
+        k = _mm256_xor_si256(k, _mm256_srli_epi64(k, 33));
+        k = avx2_mul64(k, _mm256_set1_epi64x(0xc4ceb9fe1a85ec53));
+        k = _mm256_xor_si256(k, _mm256_srli_epi64(k, 33));
+
+        return k;
+    }
+
+    __attribute__((target("avx2"))) static inline void murmur_hash_many_avx2(const char * const * bufs, const size_t * lens, size_t n, const uint32_t seed, uint64_t * out) noexcept{
+
+        constexpr size_t LANE_SZ = 4u;
+        static_assert(sizeof(size_t) == sizeof(uint64_t)); //lens are loaded as 64-bit lanes
+
+        const __m256i c1 = _mm256_set1_epi64x(0x87c37b91114253d5);
+        const __m256i c2 = _mm256_set1_epi64x(0x4cf5ad432745937f);
+        const __m256i n1 = _mm256_set1_epi64x(0x52dce729);
+        const __m256i n2 = _mm256_set1_epi64x(0x38495ab5);
+
+        size_t i = 0u;
+
+        for (; i + LANE_SZ <= n; i += LANE_SZ){
+            const char * const * lane_bufs = bufs + i;
+            size_t common_blocks = std::min({lens[i], lens[i + 1], lens[i + 2], lens[i + 3]}) / 16;
+            __m256i h1 = _mm256_set1_epi64x(seed);
+            __m256i h2 = _mm256_set1_epi64x(seed);
+
+            for (size_t j = 0; j < common_blocks; ++j){
+                __m256i x   = _mm256_set_m128i(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lane_bufs[2] + j * 16)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(lane_bufs[0] + j * 16)));
+                __m256i y   = _mm256_set_m128i(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lane_bufs[3] + j * 16)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(lane_bufs[1] + j * 16)));
+                __m256i k1  = _mm256_unpacklo_epi64(x, y);
+                __m256i k2  = _mm256_unpackhi_epi64(x, y);
+
+                k1 = avx2_mul64(k1, c1); k1 = avx2_rotl64<31>(k1); k1 = avx2_mul64(k1, c2); h1 = _mm256_xor_si256(h1, k1);
+                h1 = avx2_rotl64<27>(h1); h1 = _mm256_add_epi64(h1, h2); h1 = _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(h1, 2), h1), n1);
+                k2 = avx2_mul64(k2, c2); k2 = avx2_rotl64<33>(k2); k2 = avx2_mul64(k2, c1); h2 = _mm256_xor_si256(h2, k2);
+                h2 = avx2_rotl64<31>(h2); h2 = _mm256_add_epi64(h2, h1); h2 = _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(h2, 2), h2), n2);
+            }
+
+            alignas(32) std::array<uint64_t, LANE_SZ> lane_h1{};
+            alignas(32) std::array<uint64_t, LANE_SZ> lane_h2{};
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lane_h1.data()), h1);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lane_h2.data()), h2);
+
+            for (size_t lane = 0u; lane < LANE_SZ; ++lane){
+                murmur_absorb_lane(lane_h1[lane], lane_h2[lane], lane_bufs[lane], lens[i + lane], common_blocks);
+            }
+
+            __m256i len = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lens + i));
+            h1 = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(lane_h1.data())), len);
+            h2 = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(lane_h2.data())), len);
+            h1 = _mm256_add_epi64(h1, h2);
+            h2 = _mm256_add_epi64(h2, h1);
+            h1 = avx2_fmix64(h1);
+            h2 = avx2_fmix64(h2);
+            h1 = _mm256_add_epi64(h1, h2);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), h1);
+        }
+
+        murmur_hash_many_scalar(bufs + i, lens + i, n - i, seed, out + i);
+    }
+
+    //gcc 12 avx512fintrin.h builds some intrinsics from _mm512_undefined_*() - -Wall flags those as uninitialized inside every inlined kernel (gcc bug 105593)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    __attribute__((target("avx512f,avx512dq"))) static inline auto avx512_fmix64(__m512i k) noexcept -> __m512i{
+
+        k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+        k = _mm512_mullo_epi64(k, _mm512_set1_epi64(0xff51afd7ed558ccd));
+        k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+        k = _mm512_mullo_epi64(k, _mm512_set1_epi64(0xc4ceb9fe1a85ec53));
+        k = _mm512_xor_si512(k, _mm512_srli_epi64(k, 33));
+
+        return k;
+    }
+
+    //{block j of lhs, block j of rhs}
+    __attribute__((target("avx512f,avx512dq"))) static inline auto avx512_load_pair(const char * lhs, const char * rhs) noexcept -> __m256i{
+
+        return _mm256_set_m128i(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs)));
+    }
+
+    __attribute__((target("avx512f,avx512dq"))) static inline void murmur_hash_many_avx512(const char * const * bufs, const size_t * lens, size_t n, const uint32_t seed, uint64_t * out) noexcept{
+
+        constexpr size_t LANE_SZ = 8u;
+        static_assert(sizeof(size_t) == sizeof(uint64_t)); //lens are loaded as 64-bit lanes
+
+        const __m512i c1        = _mm512_set1_epi64(0x87c37b91114253d5);
+        const __m512i c2        = _mm512_set1_epi64(0x4cf5ad432745937f);
+        const __m512i n1        = _mm512_set1_epi64(0x52dce729);
+        const __m512i n2        = _mm512_set1_epi64(0x38495ab5);
+        const __m512i five      = _mm512_set1_epi64(5);
+        const __m512i even_idx  = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+        const __m512i odd_idx   = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+
+        size_t i = 0u;
+
+        for (; i + LANE_SZ <= n; i += LANE_SZ){
+            const char * const * lane_bufs = bufs + i;
+            size_t common_blocks = std::min({lens[i], lens[i + 1], lens[i + 2], lens[i + 3], lens[i + 4], lens[i + 5], lens[i + 6], lens[i + 7]}) / 16;
+            __m512i h1 = _mm512_set1_epi64(seed);
+            __m512i h2 = _mm512_set1_epi64(seed);
+
+            for (size_t j = 0; j < common_blocks; ++j){
+                __m512i x   = _mm512_inserti64x4(_mm512_castsi256_si512(avx512_load_pair(lane_bufs[0] + j * 16, lane_bufs[1] + j * 16)), avx512_load_pair(lane_bufs[2] + j * 16, lane_bufs[3] + j * 16), 1);
+                __m512i y   = _mm512_inserti64x4(_mm512_castsi256_si512(avx512_load_pair(lane_bufs[4] + j * 16, lane_bufs[5] + j * 16)), avx512_load_pair(lane_bufs[6] + j * 16, lane_bufs[7] + j * 16), 1);
+                __m512i k1  = _mm512_permutex2var_epi64(x, even_idx, y);
+                __m512i k2  = _mm512_permutex2var_epi64(x, odd_idx, y);
+
+                k1 = _mm512_mullo_epi64(k1, c1); k1 = _mm512_rol_epi64(k1, 31); k1 = _mm512_mullo_epi64(k1, c2); h1 = _mm512_xor_si512(h1, k1);
+                h1 = _mm512_rol_epi64(h1, 27); h1 = _mm512_add_epi64(h1, h2); h1 = _mm512_add_epi64(_mm512_mullo_epi64(h1, five), n1);
+                k2 = _mm512_mullo_epi64(k2, c2); k2 = _mm512_rol_epi64(k2, 33); k2 = _mm512_mullo_epi64(k2, c1); h2 = _mm512_xor_si512(h2, k2);
+                h2 = _mm512_rol_epi64(h2, 31); h2 = _mm512_add_epi64(h2, h1); h2 = _mm512_add_epi64(_mm512_mullo_epi64(h2, five), n2);
+            }
+
+            alignas(64) std::array<uint64_t, LANE_SZ> lane_h1{};
+            alignas(64) std::array<uint64_t, LANE_SZ> lane_h2{};
+            _mm512_store_si512(lane_h1.data(), h1);
+            _mm512_store_si512(lane_h2.data(), h2);
+
+            for (size_t lane = 0u; lane < LANE_SZ; ++lane){
+                murmur_absorb_lane(lane_h1[lane], lane_h2[lane], lane_bufs[lane], lens[i + lane], common_blocks);
+            }
+
+            __m512i len = _mm512_loadu_si512(lens + i);
+            h1 = _mm512_xor_si512(_mm512_load_si512(lane_h1.data()), len);
+            h2 = _mm512_xor_si512(_mm512_load_si512(lane_h2.data()), len);
+            h1 = _mm512_add_epi64(h1, h2);
+            h2 = _mm512_add_epi64(h2, h1);
+            h1 = avx512_fmix64(h1);
+            h2 = avx512_fmix64(h2);
+            h1 = _mm512_add_epi64(h1, h2);
+            _mm512_storeu_si512(out + i, h1);
+        }
+
+        murmur_hash_many_scalar(bufs + i, lens + i, n - i, seed, out + i);
+    }
+
+#pragma GCC diagnostic pop
+
+#endif
+
+    //AVX-512 / AVX2 / scalar by cpu_dispatch::active_isa() - no SSE4 path, 2 lanes do not pay for the transpose
+    static inline void murmur_hash_many(const char * const * bufs, const size_t * lens, size_t n, const uint32_t seed, uint64_t * out) noexcept{
+
+#if DG_CPU_DISPATCH_X86
+        switch (dg::cpu_dispatch::active_isa()){
+            case dg::cpu_dispatch::Isa::avx512:
+                murmur_hash_many_avx512(bufs, lens, n, seed, out);
+                return;
+            case dg::cpu_dispatch::Isa::avx2:
+                murmur_hash_many_avx2(bufs, lens, n, seed, out);
+                return;
+            default:
+                break;
+        }
+#endif
+
+        murmur_hash_many_scalar(bufs, lens, n, seed, out);
+    }
+
     constexpr auto hash_bytes(const char * inp, size_t n) noexcept -> size_t{
 
         return murmur_hash(inp, n);
@@ -82,10 +82,11 @@ namespace dg::trivial_serializer::utility{
 
     using namespace trivial_serializer::types;
 
+    //the lambda is forced inline - in large TUs gcc runs out of inline budget and leaves a byte-by-byte call in every load / dump
     template <size_t N>
     static constexpr void memcpy(char * dst, const char * src, const std::integral_constant<size_t, N>){
 
-        [=]<size_t ...IDX>(const std::index_sequence<IDX...>){
+        [=]<size_t ...IDX>(const std::index_sequence<IDX...>) __attribute__((always_inline)){
             ((dst[IDX] = src[IDX]), ...);
         }(std::make_index_sequence<N>());
     }  
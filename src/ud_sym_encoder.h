@@ -7,20 +7,143 @@
 #include <string>
 #include <stdexcept>
 #include "compact_serializer.h"
+#include "cpu_dispatch.h"
 #include <bit>
 #include <algorithm>
+#include <array>
+#include <span>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <memory_resource>
+#include <thread>
+
+namespace dg::ud_sym_encoder::constants{
+
+    //first byte of a VersionedEncoder frame - FusedEncoder / spawn_encoder frames (legacy and keyed) start with the plain salt and carry no outer tag
+    static constexpr uint8_t MT19937_FORMAT    = 0x01;
+    static constexpr uint8_t PHILOX_FORMAT     = 0x02;
+
+    //MurMurEncoder / FusedEncoder integrity frames - the legacy frame is untagged, its selector value never goes on the wire
+    static constexpr uint8_t MURMUR_LEGACY_FORMAT  = 0x00; //{validation_key, size, payload, integrity hash} - keyed hash over the payload + unkeyed hash over the frame
+    static constexpr uint8_t MURMUR_KEYED_FORMAT   = 0x03; //{tag, size, payload, murmur_hash128(frame, secret)[0]} - one keyed hash over the frame, full 64-bit secret
+
+    //one tag space - a keyed frame must never read as a VersionedEncoder frame
+    static_assert(MURMUR_KEYED_FORMAT != MT19937_FORMAT && MURMUR_KEYED_FORMAT != PHILOX_FORMAT);
+}
 
 namespace dg::ud_sym_encoder{
 
     struct bad_encoding_format: std::exception{}; 
     struct invalid_argument: std::exception{}; 
 
+    //span overloads write into caller-provided storage and return the number of bytes written - out must hold encoded_size(in.size()) / max_decoded_size(in.size()) bytes, invalid_argument otherwise
+    //encode(in, out) allows in to alias the tail of out (in.data() == out.data() + encoded_size(in.size()) - in.size()), decode(in, out) allows in.data() == out.data() - this is what lets DoubleEncoder chain without an intermediate buffer
+
+    //batch results packed back to back - item i is buf[offsets[i], offsets[i + 1])
+    //reuse one arena across batches to keep its capacity - a batch that throws (bad_encoding_format on any item) leaves the arena empty (size() == 0), never partially filled
+
+    struct OutputArena{
+        std::string buf;
+        std::vector<size_t> offsets;
+
+        //keeps the capacity
+        void clear() noexcept{
+
+            this->buf.clear();
+            this->offsets.clear();
+        }
+
+        auto size() const noexcept -> size_t{
+
+            return this->offsets.empty() ? 0u : this->offsets.size() - 1;
+        }
+
+        auto operator[](size_t idx) const noexcept -> std::string_view{
+
+            return std::string_view(this->buf.data() + this->offsets[idx], this->offsets[idx + 1] - this->offsets[idx]);
+        }
+    };
+
     struct EncoderInterface{
         virtual ~EncoderInterface() noexcept = default;
         virtual auto encode(const std::string&) -> std::string = 0;
         virtual auto decode(const std::string&) -> std::string = 0; 
+        virtual auto encode(std::span<const char>, std::span<char>) -> size_t = 0;
+        virtual auto decode(std::span<const char>, std::span<char>) -> size_t = 0;
+        virtual auto encoded_size(size_t) const noexcept -> size_t = 0;
+        virtual auto max_decoded_size(size_t) const noexcept -> size_t = 0;
+
+        //one arena allocation per batch, overridden where per-message setup can be shared
+        virtual void encode_batch(std::span<const std::string_view> inps, OutputArena& arena){
+
+            try{
+                arena.offsets.resize(inps.size() + 1);
+                arena.offsets[0] = 0u;
+
+                for (size_t i = 0u; i < inps.size(); ++i){
+                    arena.offsets[i + 1] = arena.offsets[i] + this->encoded_size(inps[i].size());
+                }
+
+                arena.buf.resize(arena.offsets.back());
+
+                for (size_t i = 0u; i < inps.size(); ++i){
+                    this->encode(std::span<const char>(inps[i]), std::span<char>(arena.buf.data() + arena.offsets[i], arena.offsets[i + 1] - arena.offsets[i]));
+                }
+            } catch (...){
+                arena.clear();
+                throw;
+            }
+        }
+
+        virtual void decode_batch(std::span<const std::string_view> inps, OutputArena& arena){
+
+            try{
+                size_t cap = 0u;
+
+                for (const auto& inp: inps){
+                    cap += this->max_decoded_size(inp.size());
+                }
+
+                arena.buf.resize(cap);
+                arena.offsets.resize(inps.size() + 1);
+                arena.offsets[0] = 0u;
+
+                for (size_t i = 0u; i < inps.size(); ++i){
+                    char * first            = arena.buf.data() + arena.offsets[i];
+                    arena.offsets[i + 1]    = arena.offsets[i] + this->decode(std::span<const char>(inps[i]), std::span<char>(first, cap - arena.offsets[i]));
+                }
+
+                arena.buf.resize(arena.offsets.back());
+            } catch (...){
+                arena.clear();
+                throw;
+            }
+        }
     };
 
+    //std::pmr counterparts of encode(const std::string&) / decode(const std::string&) - the result, the only allocation on these paths, comes from resource
+    //with one std::pmr::monotonic_buffer_resource per request a whole decode-and-process cycle is released at once
+
+    inline auto encode(EncoderInterface& encoder, std::string_view inp, std::pmr::memory_resource * resource) -> std::pmr::string{
+
+        auto rs = std::pmr::string(encoder.encoded_size(inp.size()), ' ', resource);
+        rs.resize(encoder.encode(std::span<const char>(inp), std::span<char>(rs)));
+
+        return rs;
+    }
+
+    inline auto decode(EncoderInterface& encoder, std::string_view inp, std::pmr::memory_resource * resource) -> std::pmr::string{
+
+        auto rs = std::pmr::string(encoder.max_decoded_size(inp.size()), ' ', resource);
+        rs.resize(encoder.decode(std::span<const char>(inp), std::span<char>(rs)));
+
+        return rs;
+    }
+
     struct MurMurMessage{
         uint64_t validation_key;
         std::string encoded;
@@ -36,46 +159,195 @@ namespace dg::ud_sym_encoder{
         }
     };
 
+    //same wire format as MurMurMessage - encoded points into the deserialized buffer
+    struct MurMurMessageView{
+        uint64_t validation_key;
+        std::string_view encoded;
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector) const{
+            reflector(validation_key, encoded);
+        }
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector){
+            reflector(validation_key, encoded);
+        }
+    };
+
     class MurMurEncoder: public virtual EncoderInterface{
 
         private:
 
+            //legacy wire format is compact_serializer::integrity_serialize(MurMurMessage) - {validation_key, size, encoded..., integrity hash}
+            static constexpr size_t HEADER_SIZE         = sizeof(uint64_t) + sizeof(dg::compact_serializer::types::size_type);
+            static constexpr size_t TRAILER_SIZE        = sizeof(dg::compact_serializer::types::hash_type);
+
+            //keyed wire format - {MURMUR_KEYED_FORMAT, size, encoded..., murmur_hash128(frame, secret)[0]}, one hash pass per encode / decode
+            static constexpr size_t KEYED_HEADER_SIZE   = sizeof(uint8_t) + sizeof(dg::compact_serializer::types::size_type);
+            static constexpr size_t KEYED_TRAILER_SIZE  = sizeof(uint64_t);
+
             uint64_t secret;
+            uint8_t format;
 
         public:
 
-            MurMurEncoder(uint64_t secret) noexcept: secret(secret){}
+            MurMurEncoder(uint64_t secret, uint8_t format = constants::MURMUR_LEGACY_FORMAT): secret(secret),
+                                                                                             format(format){
+
+                if (format != constants::MURMUR_LEGACY_FORMAT && format != constants::MURMUR_KEYED_FORMAT){
+                    throw invalid_argument();
+                }
+            }
 
             auto encode(const std::string& arg) -> std::string{
 
-                uint64_t key    = dg::hasher::murmur_hash(arg.data(), arg.size(), this->secret);
-                auto msg        = MurMurMessage{key, arg};
-                auto bstream    = std::string(dg::compact_serializer::integrity_size(msg), ' ');
-                dg::compact_serializer::integrity_serialize_into(bstream.data(), msg);
+                auto bstream = std::string(this->encoded_size(arg.size()), ' ');
+                this->encode(std::span<const char>(arg), std::span<char>(bstream));
 
                 return bstream;
             }
 
             auto decode(const std::string& arg) -> std::string{
 
-                MurMurMessage msg{};
-        
-                try{
-                    dg::compact_serializer::integrity_deserialize_into(msg, arg.data(), arg.size());
-                } catch (dg::compact_serializer::bad_encoding_format& err){
+                auto rs = std::string(this->max_decoded_size(arg.size()), ' ');
+                rs.resize(this->decode(std::span<const char>(arg), std::span<char>(rs)));
+
+                return rs;
+            }
+
+            auto encode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t sz = this->encoded_size(inp.size());
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                if (this->format == constants::MURMUR_KEYED_FORMAT){
+                    return this->encode_keyed(inp, out);
+                }
+
+                uint64_t key    = dg::hasher::murmur_hash(inp.data(), inp.size(), this->secret);
+                char * first    = out.data();
+                char * last     = first + HEADER_SIZE;
+
+                std::memmove(last, inp.data(), inp.size());
+                last = dg::compact_serializer::serialize_into(first, key);
+                last = dg::compact_serializer::serialize_into(last, static_cast<dg::compact_serializer::types::size_type>(inp.size()));
+                std::advance(last, inp.size());
+                dg::compact_serializer::serialize_into(last, dg::compact_serializer::utility::hash(first, std::distance(first, last)));
+
+                return sz;
+            }
+
+            auto decode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                std::string_view rs = this->decode_view(inp);
+
+                if (out.size() < rs.size()){
+                    throw invalid_argument();
+                }
+
+                std::memmove(out.data(), rs.data(), rs.size());
+                return rs.size();
+            }
+
+            //validates inp and returns the payload in place - no copy, no allocation, valid as long as inp is
+            //accepts both formats regardless of the encode format - a legacy frame that starts with the keyed tag is only taken as keyed if the keyed hash matches
+            auto decode_view(std::span<const char> inp) const -> std::string_view{
+
+                if (auto rs = this->decode_keyed_view(inp); rs.has_value()){
+                    return rs.value();
+                }
+
+                if (inp.size() < HEADER_SIZE + TRAILER_SIZE){
                     throw bad_encoding_format();
-                } catch (...){
-                    std::rethrow_exception(std::current_exception());
                 }
 
-                uint64_t expected_key = dg::hasher::murmur_hash(msg.encoded.data(), msg.encoded.size(), this->secret);
-                
-                if (expected_key != msg.validation_key){
+                const char * first  = inp.data();
+                const char * last   = first + (inp.size() - TRAILER_SIZE);
+                auto expected       = dg::compact_serializer::types::hash_type{};
+                auto sz             = dg::compact_serializer::types::size_type{};
+                auto msg            = MurMurMessageView{};
+
+                dg::compact_serializer::deserialize_into(expected, last);
+
+                if (expected != dg::compact_serializer::utility::hash(first, std::distance(first, last))){
+                    throw bad_encoding_format();
+                }
+
+                dg::compact_serializer::deserialize_into(sz, first + sizeof(uint64_t));
+
+                if (sz != static_cast<size_t>(std::distance(first, last)) - HEADER_SIZE){
+                    throw bad_encoding_format();
+                }
+
+                dg::compact_serializer::deserialize_into(msg, first);
+
+                if (msg.validation_key != dg::hasher::murmur_hash(msg.encoded.data(), msg.encoded.size(), this->secret)){
                     throw bad_encoding_format();
                 }
 
                 return msg.encoded;
             }
+
+            auto encoded_size(size_t sz) const noexcept -> size_t{
+
+                if (this->format == constants::MURMUR_KEYED_FORMAT){
+                    return KEYED_HEADER_SIZE + sz + KEYED_TRAILER_SIZE;
+                }
+
+                return HEADER_SIZE + sz + TRAILER_SIZE;
+            }
+
+            //upper bound over both accepted formats
+            auto max_decoded_size(size_t sz) const noexcept -> size_t{
+
+                return sz < KEYED_HEADER_SIZE + KEYED_TRAILER_SIZE ? 0u : sz - (KEYED_HEADER_SIZE + KEYED_TRAILER_SIZE);
+            }
+
+        private:
+
+            auto encode_keyed(std::span<const char> inp, std::span<char> out) const noexcept -> size_t{
+
+                char * first    = out.data();
+                char * last     = first + KEYED_HEADER_SIZE;
+
+                std::memmove(last, inp.data(), inp.size());
+                last = dg::compact_serializer::serialize_into(first, constants::MURMUR_KEYED_FORMAT);
+                last = dg::compact_serializer::serialize_into(last, static_cast<dg::compact_serializer::types::size_type>(inp.size()));
+                std::advance(last, inp.size());
+                dg::compact_serializer::serialize_into(last, dg::hasher::murmur_hash128(first, std::distance(first, last), this->secret)[0]);
+
+                return std::distance(first, last) + KEYED_TRAILER_SIZE;
+            }
+
+            auto decode_keyed_view(std::span<const char> inp) const noexcept -> std::optional<std::string_view>{
+
+                if (inp.size() < KEYED_HEADER_SIZE + KEYED_TRAILER_SIZE || std::bit_cast<uint8_t>(inp[0]) != constants::MURMUR_KEYED_FORMAT){
+                    return std::nullopt;
+                }
+
+                const char * first  = inp.data();
+                const char * last   = first + (inp.size() - KEYED_TRAILER_SIZE);
+                auto expected       = uint64_t{};
+                auto sz             = dg::compact_serializer::types::size_type{};
+
+                dg::compact_serializer::deserialize_into(sz, first + sizeof(uint8_t));
+
+                if (sz != static_cast<size_t>(std::distance(first, last)) - KEYED_HEADER_SIZE){
+                    return std::nullopt;
+                }
+
+                dg::compact_serializer::deserialize_into(expected, last);
+
+                if (expected != dg::hasher::murmur_hash128(first, std::distance(first, last), this->secret)[0]){
+                    return std::nullopt;
+                }
+
+                return std::string_view(first + KEYED_HEADER_SIZE, sz);
+            }
     };
 
     struct Mt19937Message{
@@ -100,147 +372,2103 @@ namespace dg::ud_sym_encoder{
                                                  0xfff7eee000000000ULL, 43,
                                                  6364136223846793005ULL>;
 
-    class Mt19937Encoder: public virtual EncoderInterface{
-
-        private:
+    //Philox4x32-10 (Salmon et al., Random123) - block n is a pure function of (key, n): no state to initialize, blocks are independent (vectorizable) and seekable
+    class Philox4x32{
 
-            std::string secret;
-            mt19937 salt_randgen;
-            
         public:
 
+            using key_type      = std::array<uint32_t, 2>;
+            using counter_type  = std::array<uint32_t, 4>;
 
-            Mt19937Encoder(std::string secret,
-                           mt19937 salt_randgen) noexcept: secret(std::move(secret)),
-                                                           salt_randgen(std::move(salt_randgen)){}
+            static constexpr size_t ROUNDS  = 10u;
+            static constexpr uint32_t M0    = 0xD2511F53u;
+            static constexpr uint32_t M1    = 0xCD9E8D57u;
+            static constexpr uint32_t W0    = 0x9E3779B9u;
+            static constexpr uint32_t W1    = 0xBB67AE85u;
 
-            auto encode(const std::string& arg) -> std::string{
-                
-                uint64_t salt       = this->salt_randgen();
-                uint64_t seed       = this->randomizer_seed(this->secret, salt);
-                auto randomizer     = mt19937{seed};
-                auto encoded        = std::string(arg.size(), ' ');
+            static constexpr auto block(key_type key, counter_type ctr) noexcept -> counter_type{
 
-                for (size_t i = 0u; i < arg.size(); ++i){
-                    encoded[i] = this->byte_encode(arg[i], randomizer);
+                for (size_t i = 0u; i < ROUNDS; ++i){
+                    uint64_t p0 = static_cast<uint64_t>(M0) * ctr[0];
+                    uint64_t p1 = static_cast<uint64_t>(M1) * ctr[2];
+                    ctr         = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<uint32_t>(p1), 
+                                   static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<uint32_t>(p0)};
+                    key[0]      += W0;
+                    key[1]      += W1;
                 }
 
-                return this->serialize(Mt19937Message{salt, std::move(encoded)}); 
+                return ctr;
             }
 
-            auto decode(const std::string& arg) -> std::string{
-
-                Mt19937Message msg  = this->deserialize(arg);                
-                uint64_t seed       = this->randomizer_seed(this->secret, msg.salt);
-                auto randomizer     = mt19937{seed};
-                auto decoded        = std::string(msg.encoded.size(), ' ');
+            //out[i * 16, (i + 1) * 16) = block(key, {ctr + i}) little endian, i < nblocks - SIMD paths run one block per 32-bit lane
+            static inline void fill(key_type key, uint64_t ctr, size_t nblocks, uint8_t * out) noexcept{
 
-                for (size_t i = 0u; i < msg.encoded.size(); ++i){
-                    decoded[i] = this->byte_decode(msg.encoded[i], randomizer);
+#if DG_CPU_DISPATCH_X86
+                switch (dg::cpu_dispatch::active_isa()){
+                    case dg::cpu_dispatch::Isa::avx512:
+                        fill_avx512(key, ctr, nblocks, out);
+                        return;
+                    case dg::cpu_dispatch::Isa::avx2:
+                        fill_avx2(key, ctr, nblocks, out);
+                        return;
+                    case dg::cpu_dispatch::Isa::sse4:
+                        fill_sse4(key, ctr, nblocks, out);
+                        return;
+                    default:
+                        break;
                 }
+#endif
 
-                return decoded;
+                fill_scalar(key, ctr, nblocks, out);
             }
-        
+
+            static inline void fill_scalar(key_type key, uint64_t ctr, size_t nblocks, uint8_t * out) noexcept{
+
+                for (size_t i = 0u; i < nblocks; ++i){
+                    uint64_t block_ctr  = ctr + i;
+                    auto rs             = block(key, {static_cast<uint32_t>(block_ctr), static_cast<uint32_t>(block_ctr >> 32), 0u, 0u});
+
+                    for (size_t j = 0u; j < rs.size(); ++j){
+                        dg::compact_serializer::utility::SyncedEndiannessService::dump(out + i * 16u + j * sizeof(uint32_t), rs[j]);
+                    }
+                }
+            }
+
+#if DG_CPU_DISPATCH_X86
+
         private:
 
-            auto randomizer_seed(const std::string& secret, uint64_t salt) -> uint64_t{
-                
-                std::string ss(dg::trivial_serializer::size(salt), ' ');
-                dg::trivial_serializer::serialize_into(ss.data(), salt);
-                std::string cat = secret + ss; 
+            //lane counters {ctr + lane} as low / high words - a lane whose low word wrapped carries into its high word
+            __attribute__((target("sse4.1"))) static inline void sse4_counters(uint64_t ctr, __m128i& lo, __m128i& hi) noexcept{
 
-                return dg::hasher::murmur_hash(cat.data(), cat.size());
+                const __m128i sign  = _mm_set1_epi32(static_cast<int>(0x80000000u));
+                __m128i base        = _mm_set1_epi32(static_cast<uint32_t>(ctr));
+                lo                  = _mm_add_epi32(base, _mm_set_epi32(3, 2, 1, 0));
+                hi                  = _mm_sub_epi32(_mm_set1_epi32(static_cast<uint32_t>(ctr >> 32)), _mm_cmpgt_epi32(_mm_xor_si128(base, sign), _mm_xor_si128(lo, sign)));
             }
 
-            template <class Randomizer>
-            auto get_byte_dict(Randomizer& randomizer) -> std::vector<uint8_t>{
-                
-                std::vector<uint8_t> rs(256);
-                std::iota(rs.begin(), rs.end(), 0u);
+            //32x32 -> 64 per lane - mul_epu32 only multiplies the even lanes, the odd lanes go through a shifted copy
+            __attribute__((target("sse4.1"))) static inline void sse4_mulhilo(__m128i a, __m128i m, __m128i& lo, __m128i& hi) noexcept{
+
+                __m128i even    = _mm_mul_epu32(a, m);
+                __m128i odd     = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+                lo              = _mm_mullo_epi32(a, m);
+                hi              = _mm_blend_epi16(_mm_srli_epi64(even, 32), odd, 0xCC);
+            }
+
+            __attribute__((target("sse4.1"))) static inline void fill_sse4(key_type key, uint64_t ctr, size_t nblocks, uint8_t * out) noexcept{
 
-                for (size_t i = 0u; i < 256; ++i){
-                    size_t lhs_idx = static_cast<size_t>(randomizer()) % 256;
-                    size_t rhs_idx = static_cast<size_t>(randomizer()) % 256;
-                    std::swap(rs[lhs_idx], rs[rhs_idx]);
+                constexpr size_t LANE_SZ = 4u;
+
+                const __m128i m0 = _mm_set1_epi32(M0);
+                const __m128i m1 = _mm_set1_epi32(M1);
+                size_t i = 0u;
+
+                for (; i + LANE_SZ <= nblocks; i += LANE_SZ){
+                    __m128i c0, c1;
+                    sse4_counters(ctr + i, c0, c1);
+
+                    __m128i c2      = _mm_setzero_si128();
+                    __m128i c3      = _mm_setzero_si128();
+                    uint32_t k0     = key[0];
+                    uint32_t k1     = key[1];
+
+                    for (size_t r = 0u; r < ROUNDS; ++r){
+                        __m128i lo0, hi0, lo1, hi1;
+                        sse4_mulhilo(c0, m0, lo0, hi0);
+                        sse4_mulhilo(c2, m1, lo1, hi1);
+                        c0  = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(k0));
+                        c2  = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(k1));
+                        c1  = lo1;
+                        c3  = lo0;
+                        k0  += W0;
+                        k1  += W1;
+                    }
+
+                    __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+                    __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+                    __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+                    __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + (i + 0) * 16u), _mm_unpacklo_epi64(t0, t1));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + (i + 1) * 16u), _mm_unpackhi_epi64(t0, t1));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + (i + 2) * 16u), _mm_unpacklo_epi64(t2, t3));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + (i + 3) * 16u), _mm_unpackhi_epi64(t2, t3));
                 }
 
-                return rs;
+                fill_scalar(key, ctr + i, nblocks - i, out + i * 16u);
             }
 
-            template <class Randomizer>
-            auto byte_encode(char key, Randomizer& randomizer) -> char{
+            __attribute__((target("avx2"))) static inline void avx2_counters(uint64_t ctr, __m256i& lo, __m256i& hi) noexcept{
 
-                std::vector<uint8_t> dict = this->get_byte_dict(randomizer);
-                return std::bit_cast<char>(dict[std::bit_cast<uint8_t>(key)]);
+                const __m256i sign  = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+                __m256i base        = _mm256_set1_epi32(static_cast<uint32_t>(ctr));
+                lo                  = _mm256_add_epi32(base, _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+                hi                  = _mm256_sub_epi32(_mm256_set1_epi32(static_cast<uint32_t>(ctr >> 32)), _mm256_cmpgt_epi32(_mm256_xor_si256(base, sign), _mm256_xor_si256(lo, sign)));
             }
 
-            template <class Randomizer>
-            auto byte_decode(char value, Randomizer& randomizer) -> char{
-                
-                std::vector<uint8_t> dict = this->get_byte_dict(randomizer);
-                uint8_t key = std::distance(dict.begin(), std::find(dict.begin(), dict.end(), std::bit_cast<uint8_t>(value)));
+            __attribute__((target("avx2"))) static inline void avx2_mulhilo(__m256i a, __m256i m, __m256i& lo, __m256i& hi) noexcept{
 
-                return std::bit_cast<char>(key);
+                __m256i even    = _mm256_mul_epu32(a, m);
+                __m256i odd     = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+                lo              = _mm256_mullo_epi32(a, m);
+                hi              = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
             }
 
-            auto serialize(const Mt19937Message& msg) -> std::string{
+            __attribute__((target("avx2"))) static inline void fill_avx2(key_type key, uint64_t ctr, size_t nblocks, uint8_t * out) noexcept{
 
-                size_t len = dg::trivial_serializer::size(uint64_t{}) + msg.encoded.size(); 
-                std::string rs(len, ' ');
-                char * last = dg::trivial_serializer::serialize_into(rs.data(), msg.salt);
-                std::copy(msg.encoded.begin(), msg.encoded.end(), last);
+                constexpr size_t LANE_SZ = 8u;
 
-                return rs;
-            }
+                const __m256i m0 = _mm256_set1_epi32(M0);
+                const __m256i m1 = _mm256_set1_epi32(M1);
+                size_t i = 0u;
 
-            auto deserialize(const std::string& bstream) -> Mt19937Message{
-                
-                if (bstream.size() < dg::trivial_serializer::size(uint64_t{})){
-                    throw bad_encoding_format{};
+                for (; i + LANE_SZ <= nblocks; i += LANE_SZ){
+                    __m256i c0, c1;
+                    avx2_counters(ctr + i, c0, c1);
+
+                    __m256i c2      = _mm256_setzero_si256();
+                    __m256i c3      = _mm256_setzero_si256();
+                    uint32_t k0     = key[0];
+                    uint32_t k1     = key[1];
+
+                    for (size_t r = 0u; r < ROUNDS; ++r){
+                        __m256i lo0, hi0, lo1, hi1;
+                        avx2_mulhilo(c0, m0, lo0, hi0);
+                        avx2_mulhilo(c2, m1, lo1, hi1);
+                        c0  = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(k0));
+                        c2  = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(k1));
+                        c1  = lo1;
+                        c3  = lo0;
+                        k0  += W0;
+                        k1  += W1;
+                    }
+
+                    //4x4 transpose per 128-bit half - r_j = {block j, block j + 4}
+                    __m256i t0 = _mm256_unpacklo_epi32(c0, c1);
+                    __m256i t1 = _mm256_unpacklo_epi32(c2, c3);
+                    __m256i t2 = _mm256_unpackhi_epi32(c0, c1);
+                    __m256i t3 = _mm256_unpackhi_epi32(c2, c3);
+                    __m256i r0 = _mm256_unpacklo_epi64(t0, t1);
+                    __m256i r1 = _mm256_unpackhi_epi64(t0, t1);
+                    __m256i r2 = _mm256_unpacklo_epi64(t2, t3);
+                    __m256i r3 = _mm256_unpackhi_epi64(t2, t3);
+
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + (i + 0) * 16u), _mm256_permute2x128_si256(r0, r1, 0x20));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + (i + 2) * 16u), _mm256_permute2x128_si256(r2, r3, 0x20));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + (i + 4) * 16u), _mm256_permute2x128_si256(r0, r1, 0x31));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + (i + 6) * 16u), _mm256_permute2x128_si256(r2, r3, 0x31));
                 }
 
-                Mt19937Message rs{};
-                const char * last = dg::trivial_serializer::deserialize_into(rs.salt, bstream.data()); 
-                std::copy(last, bstream.data() + bstream.size(), std::back_inserter(rs.encoded));
+                fill_scalar(key, ctr + i, nblocks - i, out + i * 16u);
+            }
 
-                return rs;
+            //_mm512_undefined_*() in the gcc 12 intrinsics - see hasher.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+            __attribute__((target("avx512f"))) static inline void avx512_counters(uint64_t ctr, __m512i& lo, __m512i& hi) noexcept{
+
+                __m512i base    = _mm512_set1_epi32(static_cast<uint32_t>(ctr));
+                lo              = _mm512_add_epi32(base, _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+                hi              = _mm512_set1_epi32(static_cast<uint32_t>(ctr >> 32));
+                hi              = _mm512_mask_add_epi32(hi, _mm512_cmplt_epu32_mask(lo, base), hi, _mm512_set1_epi32(1));
+            }
+
+            __attribute__((target("avx512f"))) static inline void avx512_mulhilo(__m512i a, __m512i m, __m512i& lo, __m512i& hi) noexcept{
+
+                __m512i even    = _mm512_mul_epu32(a, m);
+                __m512i odd     = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), m);
+                lo              = _mm512_mullo_epi32(a, m);
+                hi              = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+            }
+
+            __attribute__((target("avx512f"))) static inline void fill_avx512(key_type key, uint64_t ctr, size_t nblocks, uint8_t * out) noexcept{
+
+                constexpr size_t LANE_SZ = 16u;
+
+                const __m512i m0        = _mm512_set1_epi32(M0);
+                const __m512i m1        = _mm512_set1_epi32(M1);
+                const __m512i lo_pairs  = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);
+                const __m512i hi_pairs  = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4);
+                const __m512i lo_halves = _mm512_set_epi64(11, 10, 9, 8, 3, 2, 1, 0);
+                const __m512i hi_halves = _mm512_set_epi64(15, 14, 13, 12, 7, 6, 5, 4);
+                size_t i = 0u;
+
+                for (; i + LANE_SZ <= nblocks; i += LANE_SZ){
+                    __m512i c0, c1;
+                    avx512_counters(ctr + i, c0, c1);
+
+                    __m512i c2      = _mm512_setzero_si512();
+                    __m512i c3      = _mm512_setzero_si512();
+                    uint32_t k0     = key[0];
+                    uint32_t k1     = key[1];
+
+                    for (size_t r = 0u; r < ROUNDS; ++r){
+                        __m512i lo0, hi0, lo1, hi1;
+                        avx512_mulhilo(c0, m0, lo0, hi0);
+                        avx512_mulhilo(c2, m1, lo1, hi1);
+                        c0  = _mm512_ternarylogic_epi32(hi1, c1, _mm512_set1_epi32(k0), 0x96);
+                        c2  = _mm512_ternarylogic_epi32(hi0, c3, _mm512_set1_epi32(k1), 0x96);
+                        c1  = lo1;
+                        c3  = lo0;
+                        k0  += W0;
+                        k1  += W1;
+                    }
+
+                    //4x4 transpose per 128-bit quarter - r_j = {block j, j + 4, j + 8, j + 12}, then two rounds of 128-bit shuffles put the blocks in order
+                    __m512i t0  = _mm512_unpacklo_epi32(c0, c1);
+                    __m512i t1  = _mm512_unpacklo_epi32(c2, c3);
+                    __m512i t2  = _mm512_unpackhi_epi32(c0, c1);
+                    __m512i t3  = _mm512_unpackhi_epi32(c2, c3);
+                    __m512i r0  = _mm512_unpacklo_epi64(t0, t1);
+                    __m512i r1  = _mm512_unpackhi_epi64(t0, t1);
+                    __m512i r2  = _mm512_unpacklo_epi64(t2, t3);
+                    __m512i r3  = _mm512_unpackhi_epi64(t2, t3);
+                    __m512i s0  = _mm512_permutex2var_epi64(r0, lo_pairs, r1); //0 1 4 5
+                    __m512i s1  = _mm512_permutex2var_epi64(r0, hi_pairs, r1); //8 9 12 13
+                    __m512i s2  = _mm512_permutex2var_epi64(r2, lo_pairs, r3); //2 3 6 7
+                    __m512i s3  = _mm512_permutex2var_epi64(r2, hi_pairs, r3); //10 11 14 15
+
+                    _mm512_storeu_si512(out + (i + 0) * 16u, _mm512_permutex2var_epi64(s0, lo_halves, s2));
+                    _mm512_storeu_si512(out + (i + 4) * 16u, _mm512_permutex2var_epi64(s0, hi_halves, s2));
+                    _mm512_storeu_si512(out + (i + 8) * 16u, _mm512_permutex2var_epi64(s1, lo_halves, s3));
+                    _mm512_storeu_si512(out + (i + 12) * 16u, _mm512_permutex2var_epi64(s1, hi_halves, s3));
+                }
+
+                fill_scalar(key, ctr + i, nblocks - i, out + i * 16u);
             }
+
+#pragma GCC diagnostic pop
+
+#endif
     };
 
-    class DoubleEncoder: public virtual EncoderInterface{
+    //byte-wide draws off the Philox keystream (block n, little endian) - make_dict only keeps randomizer() % 256, so one 16-byte block serves 16 draws instead of one mt19937_64 output per draw
+    //buffered one dict at a time (512 draws = 32 blocks), the refill loop has no cross-block dependency
+
+    class PhiloxStream{
+
+        public:
+
+            using result_type = uint8_t;
+
+            static constexpr size_t BLOCK_SIZE      = 16u;
+            static constexpr size_t BUFFER_BLOCKS   = 32u;
+            static constexpr size_t BUFFER_SIZE     = BLOCK_SIZE * BUFFER_BLOCKS;
 
         private:
 
-            std::unique_ptr<EncoderInterface> first_encoder;
-            std::unique_ptr<EncoderInterface> second_encoder;
-        
+            Philox4x32::key_type key;
+            uint64_t block_idx;
+            size_t buffer_idx;
+            std::array<uint8_t, BUFFER_SIZE> buffer;
+
         public:
 
-            DoubleEncoder(std::unique_ptr<EncoderInterface> first_encoder,
-                          std::unique_ptr<EncoderInterface> second_encoder) noexcept: first_encoder(std::move(first_encoder)),
-                                                                                      second_encoder(std::move(second_encoder)){}
-            
-            auto encode(const std::string& msg) -> std::string{
-                
-                return this->second_encoder->encode(this->first_encoder->encode(msg));
+            PhiloxStream(uint64_t seed) noexcept{
+
+                this->seed(seed);
             }
 
-            auto decode(const std::string& msg) -> std::string{
+            void seed(uint64_t seed) noexcept{
+
+                this->key           = {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+                this->block_idx     = 0u;
+                this->buffer_idx    = BUFFER_SIZE;
+            }
+
+            //next draw is byte draw_idx of the keystream
+            void seek(uint64_t draw_idx) noexcept{
+
+                this->block_idx     = draw_idx / BLOCK_SIZE;
+                this->refill();
+                this->buffer_idx    = draw_idx % BLOCK_SIZE;
+            }
+
+            auto operator()() noexcept -> uint8_t{
+
+                if (this->buffer_idx == BUFFER_SIZE) [[unlikely]]{
+                    this->refill();
+                }
+
+                return this->buffer[this->buffer_idx++];
+            }
+
+            static constexpr auto min() noexcept -> uint8_t{
+
+                return std::numeric_limits<uint8_t>::min();
+            }
+
+            static constexpr auto max() noexcept -> uint8_t{
+
+                return std::numeric_limits<uint8_t>::max();
+            }
+
+        private:
 
-                return this->first_encoder->decode(this->second_encoder->decode(msg));
+            void refill() noexcept{
+
+                Philox4x32::fill(this->key, this->block_idx, BUFFER_BLOCKS, this->buffer.data());
+                this->block_idx     += BUFFER_BLOCKS;
+                this->buffer_idx    = 0u;
             }
     };
 
-    auto spawn_encoder(const std::string& secret) -> std::unique_ptr<EncoderInterface>{
+    using byte_dict_type = std::array<uint8_t, 256>;
 
-        uint64_t uint_secret = dg::hasher::murmur_hash(secret.data(), secret.size());
-        std::unique_ptr<EncoderInterface> integrity_encoder = std::make_unique<MurMurEncoder>(uint_secret);
-        std::unique_ptr<EncoderInterface> unif_dist_encoder = std::make_unique<Mt19937Encoder>(secret, mt19937{}); 
-        std::unique_ptr<EncoderInterface> combined_encoder  = std::make_unique<DoubleEncoder>(std::move(integrity_encoder), std::move(unif_dist_encoder));
+    struct ByteDictEngine{
+
+        static constexpr size_t DRAWS_PER_BYTE = 512u; //make_dict draws - byte i of a stream uses draws [i * DRAWS_PER_BYTE, (i + 1) * DRAWS_PER_BYTE)
+
+        static constexpr auto identity_dict() noexcept -> byte_dict_type{
+
+            byte_dict_type rs{};
+
+            for (size_t i = 0u; i < rs.size(); ++i){
+                rs[i] = static_cast<uint8_t>(i);
+            }
+
+            return rs;
+        }
+
+        //same draw sequence as the original per-byte vector dict - the output must stay bit-identical, only the storage changes (caller owns the dict, no allocation)
+        template <class Randomizer>
+        static inline void make_dict(byte_dict_type& dict, Randomizer& randomizer) noexcept{
+
+            constexpr byte_dict_type IDENTITY = identity_dict();
+            dict = IDENTITY;
+
+            for (size_t i = 0u; i < 256; ++i){
+                size_t lhs_idx = static_cast<size_t>(randomizer()) % 256;
+                size_t rhs_idx = static_cast<size_t>(randomizer()) % 256;
+                std::swap(dict[lhs_idx], dict[rhs_idx]);
+            }
+        }
+
+        //inverse_dict[dict[i]] == i - maintained per swap so decode is one lookup instead of a find over the dict
+        template <class Randomizer>
+        static inline void make_dict(byte_dict_type& dict, byte_dict_type& inverse_dict, Randomizer& randomizer) noexcept{
+
+            constexpr byte_dict_type IDENTITY = identity_dict();
+            dict            = IDENTITY;
+            inverse_dict    = IDENTITY;
+
+            for (size_t i = 0u; i < 256; ++i){
+                size_t lhs_idx = static_cast<size_t>(randomizer()) % 256;
+                size_t rhs_idx = static_cast<size_t>(randomizer()) % 256;
+                std::swap(dict[lhs_idx], dict[rhs_idx]);
+                inverse_dict[dict[lhs_idx]] = static_cast<uint8_t>(lhs_idx);
+                inverse_dict[dict[rhs_idx]] = static_cast<uint8_t>(rhs_idx);
+            }
+        }
+
+        template <class Randomizer>
+        static inline auto byte_encode(char key, byte_dict_type& dict, Randomizer& randomizer) noexcept -> char{
+
+            make_dict(dict, randomizer);
+            return std::bit_cast<char>(dict[std::bit_cast<uint8_t>(key)]);
+        }
+
+        template <class Randomizer>
+        static inline auto byte_decode(char value, byte_dict_type& dict, byte_dict_type& inverse_dict, Randomizer& randomizer) noexcept -> char{
+
+            make_dict(dict, inverse_dict, randomizer);
+            return std::bit_cast<char>(inverse_dict[std::bit_cast<uint8_t>(value)]);
+        }
+    };
+
+    //out[i] = dict[inp[i]] over a whole run of bytes - the table apply of the block-constant modes
+    //out may equal inp or sit before it (every vector is loaded before its store)
+    //AVX-512 VBMI: 2 vpermi2b + blend per 64 bytes, AVX-512BW / AVX2: one pshufb per high nibble (16) masked by a nibble compare
+    //no SSE4 path - 16 lookups per 16 bytes lose to the scalar loop
+
+    struct ByteShuffleEngine{
+
+        static inline void apply(const byte_dict_type& dict, const char * inp, size_t sz, char * out) noexcept{
+
+#if DG_CPU_DISPATCH_X86
+            switch (dg::cpu_dispatch::active_isa()){
+                case dg::cpu_dispatch::Isa::avx512:
+                    if (dg::cpu_dispatch::has_avx512_vbmi()){
+                        apply_avx512vbmi(dict, inp, sz, out);
+                    } else{
+                        apply_avx512bw(dict, inp, sz, out);
+                    }
+                    return;
+                case dg::cpu_dispatch::Isa::avx2:
+                    apply_avx2(dict, inp, sz, out);
+                    return;
+                default:
+                    break;
+            }
+#endif
+
+            apply_scalar(dict, inp, sz, out);
+        }
+
+        static inline void apply_scalar(const byte_dict_type& dict, const char * inp, size_t sz, char * out) noexcept{
+
+            for (size_t i = 0u; i < sz; ++i){
+                out[i] = std::bit_cast<char>(dict[std::bit_cast<uint8_t>(inp[i])]);
+            }
+        }
+
+#if DG_CPU_DISPATCH_X86
+
+        __attribute__((target("avx2"))) static inline void apply_avx2(const byte_dict_type& dict, const char * inp, size_t sz, char * out) noexcept{
+
+            constexpr size_t VEC_SZ = 32u;
+
+            const __m256i nibble = _mm256_set1_epi8(0x0F);
+            __m256i tables[16];
+            size_t i = 0u;
+
+            for (size_t h = 0u; h < 16u; ++h){
+                tables[h] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(dict.data() + h * 16u)));
+            }
+
+            for (; i + VEC_SZ <= sz; i += VEC_SZ){
+                __m256i x   = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inp + i));
+                __m256i lo  = _mm256_and_si256(x, nibble);
+                __m256i hi  = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+                __m256i rs  = _mm256_setzero_si256();
+
+                for (size_t h = 0u; h < 16u; ++h){
+                    rs = _mm256_or_si256(rs, _mm256_and_si256(_mm256_shuffle_epi8(tables[h], lo), _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(static_cast<char>(h)))));
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), rs);
+            }
+
+            apply_scalar(dict, inp + i, sz - i, out + i);
+        }
+
+        //_mm512_undefined_*() in the gcc 12 intrinsics - see hasher.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+        //first n bytes of a 64-byte vector, n < 64
+        static inline auto avx512_tail_mask(size_t n) noexcept -> uint64_t{
+
+            return (uint64_t{1} << n) - 1u;
+        }
+
+        __attribute__((target("avx512f,avx512bw"))) static inline void apply_avx512bw(const byte_dict_type& dict, const char * inp, size_t sz, char * out) noexcept{
+
+            constexpr size_t VEC_SZ = 64u;
+
+            const __m512i nibble = _mm512_set1_epi8(0x0F);
+            __m512i tables[16];
+            size_t i = 0u;
+
+            for (size_t h = 0u; h < 16u; ++h){
+                tables[h] = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(dict.data() + h * 16u)));
+            }
+
+            auto apply_vec = [&](__m512i x) __attribute__((target("avx512f,avx512bw"))){
+                __m512i lo  = _mm512_and_si512(x, nibble);
+                __m512i hi  = _mm512_and_si512(_mm512_srli_epi16(x, 4), nibble);
+                __m512i rs  = _mm512_setzero_si512();
+
+                for (size_t h = 0u; h < 16u; ++h){
+                    rs = _mm512_mask_shuffle_epi8(rs, _mm512_cmpeq_epi8_mask(hi, _mm512_set1_epi8(static_cast<char>(h))), tables[h], lo);
+                }
+
+                return rs;
+            };
+
+            for (; i + VEC_SZ <= sz; i += VEC_SZ){
+                _mm512_storeu_si512(out + i, apply_vec(_mm512_loadu_si512(inp + i)));
+            }
+
+            if (i != sz){
+                __mmask64 mask = avx512_tail_mask(sz - i);
+                _mm512_mask_storeu_epi8(out + i, mask, apply_vec(_mm512_maskz_loadu_epi8(mask, inp + i)));
+            }
+        }
+
+        __attribute__((target("avx512f,avx512bw,avx512vbmi"))) static inline void apply_avx512vbmi(const byte_dict_type& dict, const char * inp, size_t sz, char * out) noexcept{
+
+            constexpr size_t VEC_SZ = 64u;
+
+            const __m512i t0 = _mm512_loadu_si512(dict.data() + 0 * VEC_SZ);
+            const __m512i t1 = _mm512_loadu_si512(dict.data() + 1 * VEC_SZ);
+            const __m512i t2 = _mm512_loadu_si512(dict.data() + 2 * VEC_SZ);
+            const __m512i t3 = _mm512_loadu_si512(dict.data() + 3 * VEC_SZ);
+            size_t i = 0u;
+
+            //vpermi2b indexes 128 bytes by the low 7 bits, the high bit picks the table half
+            auto apply_vec = [&](__m512i x) __attribute__((target("avx512f,avx512bw,avx512vbmi"))){
+                return _mm512_mask_blend_epi8(_mm512_movepi8_mask(x), _mm512_permutex2var_epi8(t0, x, t1), _mm512_permutex2var_epi8(t2, x, t3));
+            };
+
+            for (; i + VEC_SZ <= sz; i += VEC_SZ){
+                _mm512_storeu_si512(out + i, apply_vec(_mm512_loadu_si512(inp + i)));
+            }
+
+            if (i != sz){
+                __mmask64 mask = avx512_tail_mask(sz - i);
+                _mm512_mask_storeu_epi8(out + i, mask, apply_vec(_mm512_maskz_loadu_epi8(mask, inp + i)));
+            }
+        }
+
+#pragma GCC diagnostic pop
+
+#endif
+    };
+
+    //randomizer seed = murmur_hash(secret + serialized(salt)) - the secret is absorbed once at construction, only the salt tail is hashed per message
+    class SaltedSeeder{
+
+        private:
+
+            dg::hasher::MurmurState secret_state;
+
+        public:
+
+            SaltedSeeder(const std::string& secret) noexcept: secret_state(){
+                
+                this->secret_state.update(secret.data(), secret.size());
+            }
+
+            auto seed(uint64_t salt) const noexcept -> uint64_t{
+
+                std::array<char, sizeof(uint64_t)> ss{};
+                dg::trivial_serializer::serialize_into(ss.data(), salt);
+                dg::hasher::MurmurState state = this->secret_state;
+                state.update(ss.data(), ss.size());
+
+                return state.finalize();
+            }
+    };
+
+    struct SaltGeneratorInterface{
+        virtual ~SaltGeneratorInterface() noexcept = default;
+        virtual auto get() noexcept -> uint64_t = 0;
+    };
+
+    //sequential - one instance per thread
+    class Mt19937SaltGenerator: public virtual SaltGeneratorInterface{
+
+        private:
+
+            mt19937 randgen;
+
+        public:
+
+            Mt19937SaltGenerator(mt19937 randgen) noexcept: randgen(std::move(randgen)){}
+
+            auto get() noexcept -> uint64_t{
+
+                return this->randgen();
+            }
+    };
+
+    //lock-free - salt = fmix64(seed + counter), fmix64 is a bijection so salts do not repeat within 2^64 draws regardless of how many threads share the generator
+    class AtomicSaltGenerator: public virtual SaltGeneratorInterface{
+
+        private:
+
+            std::atomic<uint64_t> counter;
+
+        public:
+
+            AtomicSaltGenerator(uint64_t seed) noexcept: counter(seed){}
+
+            auto get() noexcept -> uint64_t{
+
+                return dg::hasher::fmix64(this->counter.fetch_add(1u, std::memory_order_relaxed));
+            }
+    };
+
+    class Mt19937Encoder: public virtual EncoderInterface{
+
+        private:
+
+            SaltedSeeder seeder;
+            std::unique_ptr<SaltGeneratorInterface> salt_gen;
+            
+        public:
+
+
+            Mt19937Encoder(const std::string& secret,
+                           std::unique_ptr<SaltGeneratorInterface> salt_gen) noexcept: seeder(secret),
+                                                                                       salt_gen(std::move(salt_gen)){}
+
+            Mt19937Encoder(const std::string& secret,
+                           mt19937 salt_randgen): Mt19937Encoder(secret, std::make_unique<Mt19937SaltGenerator>(std::move(salt_randgen))){}
+
+            auto encode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->encoded_size(arg.size()), ' ');
+                this->encode(std::span<const char>(arg), std::span<char>(rs));
+
+                return rs;
+            }
+
+            auto decode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->max_decoded_size(arg.size()), ' ');
+                rs.resize(this->decode(std::span<const char>(arg), std::span<char>(rs)));
+
+                return rs;
+            }
+
+            //the wire format is {salt, encoded...} - encoded[i] reads inp[i] before writing, so inp may sit at out + sizeof(salt)
+            auto encode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t sz = this->encoded_size(inp.size());
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                uint64_t salt       = this->salt_gen->get();
+                uint64_t seed       = this->seeder.seed(salt);
+                auto randomizer     = mt19937{seed};
+                auto dict           = byte_dict_type{};
+                char * last         = dg::trivial_serializer::serialize_into(out.data(), salt);
+
+                for (size_t i = 0u; i < inp.size(); ++i){
+                    last[i] = ByteDictEngine::byte_encode(inp[i], dict, randomizer);
+                }
+
+                return sz;
+            }
+
+            auto decode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                if (inp.size() < dg::trivial_serializer::size(uint64_t{})){
+                    throw bad_encoding_format{};
+                }
+
+                uint64_t salt       = {};
+                const char * first  = dg::trivial_serializer::deserialize_into(salt, inp.data());
+                size_t sz           = inp.size() - dg::trivial_serializer::size(uint64_t{});
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                uint64_t seed       = this->seeder.seed(salt);
+                auto randomizer     = mt19937{seed};
+                auto dict           = byte_dict_type{};
+                auto inverse_dict   = byte_dict_type{};
+
+                for (size_t i = 0u; i < sz; ++i){
+                    out[i] = ByteDictEngine::byte_decode(first[i], dict, inverse_dict, randomizer);
+                }
+
+                return sz;
+            }
+
+            auto encoded_size(size_t sz) const noexcept -> size_t{
+
+                return dg::trivial_serializer::size(uint64_t{}) + sz;
+            }
+
+            auto max_decoded_size(size_t sz) const noexcept -> size_t{
+
+                return sz < dg::trivial_serializer::size(uint64_t{}) ? 0u : sz - dg::trivial_serializer::size(uint64_t{});
+            }
+    };
+
+    //{salt, encoded...} like Mt19937Encoder, but one dict per block_size bytes instead of one per byte - the dict is drawn from the same salted mt19937 stream (make_dict draw order) at every block start
+    //the apply is ByteShuffleEngine, so throughput is bounded by the shuffles instead of the draws
+    //weaker than the per-byte dict: equal bytes within a block encode to equal bytes - both sides must agree on block_size, it is not on the wire
+
+    class BlockPermutationEncoder: public virtual EncoderInterface{
+
+        private:
+
+            static constexpr size_t SALT_SIZE = sizeof(uint64_t);
+
+            SaltedSeeder seeder;
+            std::unique_ptr<SaltGeneratorInterface> salt_gen;
+            size_t block_size;
+
+        public:
+
+            static constexpr size_t DEFAULT_BLOCK_SIZE = size_t{1} << 16; //a dict costs ~512 mt19937 draws + 256 swaps (a few us) - 64 KiB keeps that below the apply
+
+            BlockPermutationEncoder(const std::string& secret,
+                                    std::unique_ptr<SaltGeneratorInterface> salt_gen,
+                                    size_t block_size = DEFAULT_BLOCK_SIZE): seeder(secret),
+                                                                             salt_gen(std::move(salt_gen)),
+                                                                             block_size(block_size){
+
+                if (block_size == 0u){
+                    throw invalid_argument();
+                }
+            }
+
+            BlockPermutationEncoder(const std::string& secret,
+                                    mt19937 salt_randgen,
+                                    size_t block_size = DEFAULT_BLOCK_SIZE): BlockPermutationEncoder(secret, std::make_unique<Mt19937SaltGenerator>(std::move(salt_randgen)), block_size){}
+
+            auto encode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->encoded_size(arg.size()), ' ');
+                this->encode(std::span<const char>(arg), std::span<char>(rs));
+
+                return rs;
+            }
+
+            auto decode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->max_decoded_size(arg.size()), ' ');
+                rs.resize(this->decode(std::span<const char>(arg), std::span<char>(rs)));
+
+                return rs;
+            }
+
+            //same aliasing as Mt19937Encoder - inp may sit at out + sizeof(salt)
+            auto encode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t sz = this->encoded_size(inp.size());
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                uint64_t salt       = this->salt_gen->get();
+                auto randomizer     = mt19937{this->seeder.seed(salt)};
+                auto dict           = byte_dict_type{};
+                char * last         = dg::trivial_serializer::serialize_into(out.data(), salt);
+
+                for (size_t first = 0u; first < inp.size(); first += this->block_size){
+                    ByteDictEngine::make_dict(dict, randomizer);
+                    ByteShuffleEngine::apply(dict, inp.data() + first, std::min(this->block_size, inp.size() - first), last + first);
+                }
+
+                return sz;
+            }
+
+            auto decode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                if (inp.size() < SALT_SIZE){
+                    throw bad_encoding_format();
+                }
+
+                uint64_t salt       = {};
+                const char * src    = dg::trivial_serializer::deserialize_into(salt, inp.data());
+                size_t sz           = inp.size() - SALT_SIZE;
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                auto randomizer     = mt19937{this->seeder.seed(salt)};
+                auto dict           = byte_dict_type{};
+                auto inverse_dict   = byte_dict_type{};
+
+                for (size_t first = 0u; first < sz; first += this->block_size){
+                    ByteDictEngine::make_dict(dict, inverse_dict, randomizer);
+                    ByteShuffleEngine::apply(inverse_dict, src + first, std::min(this->block_size, sz - first), out.data() + first);
+                }
+
+                return sz;
+            }
+
+            auto encoded_size(size_t sz) const noexcept -> size_t{
+
+                return SALT_SIZE + sz;
+            }
+
+            auto max_decoded_size(size_t sz) const noexcept -> size_t{
+
+                return sz < SALT_SIZE ? 0u : sz - SALT_SIZE;
+            }
+    };
+
+    //SegmentedEncoder opt-in - one dict per block_size bytes (the BlockPermutationEncoder mode) instead of one per byte: equal bytes within a block encode to equal bytes
+    //GB/s instead of the per-byte draw rate, for payloads where that leak is acceptable
+    struct WeakBlockConstantDicts{
+        size_t block_size = BlockPermutationEncoder::DEFAULT_BLOCK_SIZE;
+    };
+
+    //{salt, segment_size, size, hash[0..segment_count), encoded...} - the payload is cut into segment_size runs, each encoded on its own from seed_i = murmur_hash128({size, i}, seeder.seed(salt))
+    //a fresh dict per byte by default (the Mt19937Encoder strength), WeakBlockConstantDicts for the block-constant mode - the mode is not on the wire, both sides must agree on it
+    //hash[i] = murmur_hash128(segment i, seed_i)[0] - keyed per segment, so segments can be checked on the worker that decoded them, and reordered / dropped / truncated segments fail (size and i are in every seed)
+    //segments are spread across up to thread_count std::jthread workers started per call (contiguous runs of segments per worker, the caller runs the first) - segment_size is on the wire, thread_count is local
+    //encode(in, out) with in.data() at the payload of out (in at the tail, as DoubleEncoder places it) runs every segment in place on the workers, any other overlap throws invalid_argument
+    //decode(in, out) with out.data() at or before the payload of in (in.data() == out.data() included) runs on one thread, any other overlap throws invalid_argument
+
+    class SegmentedEncoder: public virtual EncoderInterface{
+
+        private:
+
+            static constexpr size_t HEADER_SIZE = sizeof(uint64_t) * 3;
+            static constexpr size_t HASH_SIZE   = sizeof(uint64_t);
+
+            SaltedSeeder seeder;
+            std::unique_ptr<SaltGeneratorInterface> salt_gen;
+            size_t segment_size;
+            size_t block_size;
+            size_t thread_count;
+
+        public:
+
+            static constexpr size_t MIN_SEGMENT_SIZE                = size_t{1} << 12; //bounds the hash table (and the per-segment seeding) a crafted frame can ask for
+            static constexpr size_t DEFAULT_SEGMENT_SIZE            = size_t{1} << 16; //per-byte dicts run at ~200 KB/s per thread - a 64 KiB segment is ~0.3 s, mid-sized messages still split
+            static constexpr size_t BLOCK_CONSTANT_SEGMENT_SIZE     = size_t{1} << 20; //~150 us of apply per segment at avx512 rates - well above the jthread start cost
+
+            SegmentedEncoder(const std::string& secret,
+                             std::unique_ptr<SaltGeneratorInterface> salt_gen,
+                             size_t thread_count    = std::thread::hardware_concurrency(),
+                             size_t segment_size    = DEFAULT_SEGMENT_SIZE): SegmentedEncoder(secret, std::move(salt_gen), WeakBlockConstantDicts{1u}, thread_count, segment_size){}
+
+            SegmentedEncoder(const std::string& secret,
+                             mt19937 salt_randgen,
+                             size_t thread_count    = std::thread::hardware_concurrency(),
+                             size_t segment_size    = DEFAULT_SEGMENT_SIZE): SegmentedEncoder(secret, std::make_unique<Mt19937SaltGenerator>(std::move(salt_randgen)), thread_count, segment_size){}
+
+            SegmentedEncoder(const std::string& secret,
+                             std::unique_ptr<SaltGeneratorInterface> salt_gen,
+                             WeakBlockConstantDicts dicts,
+                             size_t thread_count    = std::thread::hardware_concurrency(),
+                             size_t segment_size    = BLOCK_CONSTANT_SEGMENT_SIZE): seeder(secret),
+                                                                                    salt_gen(std::move(salt_gen)),
+                                                                                    segment_size(segment_size),
+                                                                                    block_size(dicts.block_size),
+                                                                                    thread_count(std::max(thread_count, size_t{1})){
+
+                if (segment_size < MIN_SEGMENT_SIZE || dicts.block_size == 0u){
+                    throw invalid_argument();
+                }
+            }
+
+            SegmentedEncoder(const std::string& secret,
+                             mt19937 salt_randgen,
+                             WeakBlockConstantDicts dicts,
+                             size_t thread_count    = std::thread::hardware_concurrency(),
+                             size_t segment_size    = BLOCK_CONSTANT_SEGMENT_SIZE): SegmentedEncoder(secret, std::make_unique<Mt19937SaltGenerator>(std::move(salt_randgen)), dicts, thread_count, segment_size){}
+
+            auto encode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->encoded_size(arg.size()), ' ');
+                this->encode(std::span<const char>(arg), std::span<char>(rs));
+
+                return rs;
+            }
+
+            auto decode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->max_decoded_size(arg.size()), ' ');
+                rs.resize(this->decode(std::span<const char>(arg), std::span<char>(rs)));
+
+                return rs;
+            }
+
+            auto encode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t sz = this->encoded_size(inp.size());
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                size_t segment_size     = this->segment_size;
+                size_t block_size       = this->block_size;
+                size_t segment_count    = this->get_segment_count(inp.size(), segment_size);
+                char * table            = out.data() + HEADER_SIZE;
+                char * payload          = table + segment_count * HASH_SIZE;
+
+                //the header and the table would overwrite unread input, and the apply would run ahead of it
+                if (payload != inp.data() && is_overlapped(inp, out)){
+                    throw invalid_argument();
+                }
+
+                uint64_t salt           = this->salt_gen->get();
+                uint64_t base_seed      = this->seeder.seed(salt);
+
+                char * last = dg::trivial_serializer::serialize_into(out.data(), salt);
+                last        = dg::trivial_serializer::serialize_into(last, static_cast<uint64_t>(segment_size));
+                last        = dg::trivial_serializer::serialize_into(last, static_cast<uint64_t>(inp.size()));
+
+                //the hash is taken before the apply - segment i may be encoded in place
+                this->for_each_segment(segment_count, true, [=](size_t idx){
+                    size_t first        = std::min(inp.size(), idx * segment_size);
+                    size_t len          = std::min(segment_size, inp.size() - first);
+                    uint64_t seed       = get_segment_seed(base_seed, inp.size(), idx);
+                    auto randomizer     = mt19937{seed};
+                    auto dict           = byte_dict_type{};
+
+                    dg::trivial_serializer::serialize_into(table + idx * HASH_SIZE, dg::hasher::murmur_hash128(inp.data() + first, len, seed)[0]);
+
+                    for (size_t i = 0u; i < len; i += block_size){
+                        ByteDictEngine::make_dict(dict, randomizer);
+                        ByteShuffleEngine::apply(dict, inp.data() + first + i, std::min(block_size, len - i), payload + first + i);
+                    }
+                });
+
+                return sz;
+            }
+
+            auto decode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                if (inp.size() < HEADER_SIZE){
+                    throw bad_encoding_format();
+                }
+
+                uint64_t salt           = {};
+                uint64_t segment_size   = {};
+                uint64_t sz             = {};
+                const char * table      = dg::trivial_serializer::deserialize_into(salt, inp.data());
+                table                   = dg::trivial_serializer::deserialize_into(segment_size, table);
+                table                   = dg::trivial_serializer::deserialize_into(sz, table);
+
+                if (segment_size < MIN_SEGMENT_SIZE || sz > inp.size()){
+                    throw bad_encoding_format();
+                }
+
+                size_t segment_count = this->get_segment_count(sz, segment_size);
+
+                if (inp.size() != HEADER_SIZE + segment_count * HASH_SIZE + sz){
+                    throw bad_encoding_format();
+                }
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                uint64_t base_seed      = this->seeder.seed(salt);
+                size_t block_size       = this->block_size;
+                const char * payload    = table + segment_count * HASH_SIZE;
+                bool is_overlap         = is_overlapped(inp, out);
+                auto hashes             = std::vector<uint64_t>(segment_count);
+                auto is_bad             = std::atomic<bool>(false);
+
+                //out past the payload - the apply would write ahead of unread input
+                if (is_overlap && out.data() > payload){
+                    throw invalid_argument();
+                }
+
+                //copied out - with inp.data() == out.data() the first segment overwrites the table
+
+                for (size_t i = 0u; i < segment_count; ++i){
+                    dg::trivial_serializer::deserialize_into(hashes[i], table + i * HASH_SIZE);
+                }
+
+                this->for_each_segment(segment_count, !is_overlap, [=, &hashes, &is_bad](size_t idx){
+                    size_t first        = std::min(static_cast<size_t>(sz), idx * segment_size);
+                    size_t len          = std::min(static_cast<size_t>(segment_size), static_cast<size_t>(sz) - first);
+                    uint64_t seed       = get_segment_seed(base_seed, sz, idx);
+                    auto randomizer     = mt19937{seed};
+                    auto dict           = byte_dict_type{};
+                    auto inverse_dict   = byte_dict_type{};
+
+                    for (size_t i = 0u; i < len; i += block_size){
+                        ByteDictEngine::make_dict(dict, inverse_dict, randomizer);
+                        ByteShuffleEngine::apply(inverse_dict, payload + first + i, std::min(block_size, len - i), out.data() + first + i);
+                    }
+
+                    if (hashes[idx] != dg::hasher::murmur_hash128(out.data() + first, len, seed)[0]){
+                        is_bad.store(true, std::memory_order_relaxed);
+                    }
+                });
+
+                if (is_bad.load(std::memory_order_relaxed)){
+                    throw bad_encoding_format();
+                }
+
+                return sz;
+            }
+
+            auto encoded_size(size_t sz) const noexcept -> size_t{
+
+                return HEADER_SIZE + this->get_segment_count(sz, this->segment_size) * HASH_SIZE + sz;
+            }
+
+            auto max_decoded_size(size_t sz) const noexcept -> size_t{
+
+                return sz < HEADER_SIZE + HASH_SIZE ? 0u : sz - (HEADER_SIZE + HASH_SIZE);
+            }
+
+        private:
+
+            //at least one segment - an empty payload still carries a keyed hash
+            static auto get_segment_count(size_t sz, size_t segment_size) noexcept -> size_t{
+
+                return sz == 0u ? size_t{1} : (sz - 1u) / segment_size + 1u;
+            }
+
+            static auto get_segment_seed(uint64_t base_seed, uint64_t sz, uint64_t idx) noexcept -> uint64_t{
+
+                std::array<char, sizeof(uint64_t) * 2> buf{};
+                dg::trivial_serializer::serialize_into(dg::trivial_serializer::serialize_into(buf.data(), sz), idx);
+
+                return dg::hasher::murmur_hash128(buf.data(), buf.size(), base_seed)[0];
+            }
+
+            static auto is_overlapped(std::span<const char> inp, std::span<char> out) noexcept -> bool{
+
+                return inp.data() < out.data() + out.size() && out.data() < inp.data() + inp.size();
+            }
+
+            //task must not throw - it runs on the workers
+            template <class Task>
+            void for_each_segment(size_t segment_count, bool is_parallel, const Task& task) const{
+
+                size_t worker_count = is_parallel ? std::min(this->thread_count, segment_count) : size_t{1};
+                auto workers        = std::vector<std::jthread>{};
+
+                auto run = [&](size_t worker_idx){
+                    size_t first    = segment_count * worker_idx / worker_count;
+                    size_t last     = segment_count * (worker_idx + 1u) / worker_count;
+
+                    for (size_t i = first; i < last; ++i){
+                        task(i);
+                    }
+                };
+
+                workers.reserve(worker_count - 1u);
+
+                for (size_t i = 1u; i < worker_count; ++i){
+                    workers.emplace_back(run, i);
+                }
+
+                run(0u);
+            }
+    };
+
+    class DoubleEncoder: public virtual EncoderInterface{
+
+        private:
+
+            std::unique_ptr<EncoderInterface> first_encoder;
+            std::unique_ptr<EncoderInterface> second_encoder;
+        
+        public:
+
+            DoubleEncoder(std::unique_ptr<EncoderInterface> first_encoder,
+                          std::unique_ptr<EncoderInterface> second_encoder) noexcept: first_encoder(std::move(first_encoder)),
+                                                                                      second_encoder(std::move(second_encoder)){}
+            
+            auto encode(const std::string& msg) -> std::string{
+                
+                auto rs = std::string(this->encoded_size(msg.size()), ' ');
+                this->encode(std::span<const char>(msg), std::span<char>(rs));
+
+                return rs;
+            }
+
+            auto decode(const std::string& msg) -> std::string{
+
+                auto rs = std::string(this->max_decoded_size(msg.size()), ' ');
+                rs.resize(this->decode(std::span<const char>(msg), std::span<char>(rs)));
+
+                return rs;
+            }
+
+            //first_encoder writes to the tail of out, second_encoder encodes that tail in place
+            auto encode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t intermediate_sz  = this->first_encoder->encoded_size(inp.size());
+                size_t sz               = this->second_encoder->encoded_size(intermediate_sz);
+
+                if (out.size() < sz || sz < intermediate_sz){
+                    throw invalid_argument();
+                }
+
+                auto intermediate = out.subspan(sz - intermediate_sz, intermediate_sz);
+                this->first_encoder->encode(inp, intermediate);
+
+                return this->second_encoder->encode(intermediate, out);
+            }
+
+            auto decode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t intermediate_sz = this->second_encoder->decode(inp, out);
+                return this->first_encoder->decode(out.first(intermediate_sz), out);
+            }
+
+            auto encoded_size(size_t sz) const noexcept -> size_t{
+
+                return this->second_encoder->encoded_size(this->first_encoder->encoded_size(sz));
+            }
+
+            //out doubles as the intermediate buffer, so it must fit both stages
+            auto max_decoded_size(size_t sz) const noexcept -> size_t{
+
+                size_t intermediate_sz = this->second_encoder->max_decoded_size(sz);
+                return std::max(intermediate_sz, this->first_encoder->max_decoded_size(intermediate_sz));
+            }
+    };
+
+    //{salt, E(validation_key), E(size), E(encoded...), E(integrity hash)} where E is the substitution stream of a Randomizer seeded from the salt
+    //FusedEncoder (Randomizer = mt19937) is byte-identical to DoubleEncoder(MurMurEncoder, Mt19937Encoder), PhiloxEncoder is the same frame over the Philox keystream
+    //encode reads the payload twice (validation_key must be known before the stream starts), decode once - both write straight into out without intermediate frames
+    //format = MURMUR_KEYED_FORMAT encodes {salt, E(tag), E(size), E(encoded...), E(keyed hash)} instead (DoubleEncoder(MurMurEncoder keyed, Mt19937Encoder)) - one hash pass, one payload read
+    //decode takes both frames regardless of format - the decoded header picks the layout
+
+    template <class Randomizer>
+    class BasicFusedEncoder: public virtual EncoderInterface{
+
+        protected:
+
+            using size_type         = dg::compact_serializer::types::size_type;
+            using hash_type         = dg::compact_serializer::types::hash_type;
+
+            static constexpr size_t SALT_SIZE           = sizeof(uint64_t);
+            static constexpr size_t HEADER_SIZE         = sizeof(uint64_t) + sizeof(size_type);
+            static constexpr size_t KEYED_HEADER_SIZE   = sizeof(uint8_t) + sizeof(size_type);
+            static constexpr size_t TRAILER_SIZE        = sizeof(hash_type);
+            static constexpr size_t BLOCK_SIZE          = 16u;
+            static constexpr uint32_t INTEGRITY_SEED    = 0xFF;
+
+            static_assert(HEADER_SIZE == BLOCK_SIZE); //payload blocks of the integrity hash line up with the payload itself
+            static_assert(KEYED_HEADER_SIZE <= HEADER_SIZE); //the first KEYED_HEADER_SIZE decoded bytes tell the frames apart
+
+            uint64_t integrity_secret;
+            SaltedSeeder seeder;
+            std::unique_ptr<SaltGeneratorInterface> salt_gen;
+            uint8_t format;
+
+        public:
+
+            BasicFusedEncoder(uint64_t integrity_secret,
+                              const std::string& secret,
+                              std::unique_ptr<SaltGeneratorInterface> salt_gen,
+                              uint8_t format = constants::MURMUR_LEGACY_FORMAT): integrity_secret(integrity_secret),
+                                                                                  seeder(secret),
+                                                                                  salt_gen(std::move(salt_gen)),
+                                                                                  format(format){
+
+                if (format != constants::MURMUR_LEGACY_FORMAT && format != constants::MURMUR_KEYED_FORMAT){
+                    throw invalid_argument();
+                }
+            }
+
+            BasicFusedEncoder(uint64_t integrity_secret,
+                              const std::string& secret,
+                              mt19937 salt_randgen,
+                              uint8_t format = constants::MURMUR_LEGACY_FORMAT): BasicFusedEncoder(integrity_secret, secret, std::make_unique<Mt19937SaltGenerator>(std::move(salt_randgen)), format){}
+
+            auto encode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->encoded_size(arg.size()), ' ');
+                this->encode(std::span<const char>(arg), std::span<char>(rs));
+
+                return rs;
+            }
+
+            auto decode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->max_decoded_size(arg.size()), ' ');
+                rs.resize(this->decode(std::span<const char>(arg), std::span<char>(rs)));
+
+                return rs;
+            }
+
+            auto encode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t sz = this->encoded_size(inp.size());
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                uint64_t salt       = this->salt_gen->get();
+                auto randomizer     = Randomizer{this->seeder.seed(salt)};
+                auto dict           = byte_dict_type{};
+
+                if (this->format == constants::MURMUR_KEYED_FORMAT){
+                    return this->encode_keyed_frame(inp, out, salt, randomizer, dict);
+                }
+
+                uint64_t key        = dg::hasher::murmur_hash(inp.data(), inp.size(), this->integrity_secret);
+
+                return this->encode_frame(inp, out, key, salt, randomizer, dict);
+            }
+
+            auto decode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                auto randomizer     = Randomizer{this->seeder.seed(this->read_salt(inp))};
+                auto dict           = byte_dict_type{};
+                auto inverse_dict   = byte_dict_type{};
+
+                return this->decode_frame(inp, out, randomizer, dict, inverse_dict);
+            }
+
+            //legacy frames - validation keys of the whole batch go through murmur_hash_many, that is the saving, Randomizer::seed runs the same state init as construction, so the per-item seeding costs what a single encode does
+            //keyed frames have no validation key, the batch is the single encodes into one arena
+            void encode_batch(std::span<const std::string_view> inps, OutputArena& arena){
+
+                try{
+                    bool is_keyed       = this->format == constants::MURMUR_KEYED_FORMAT;
+                    auto bufs           = std::vector<const char *>(inps.size());
+                    auto lens           = std::vector<size_t>(inps.size());
+                    auto keys           = std::vector<uint64_t>(is_keyed ? 0u : inps.size());
+                    auto randomizer     = Randomizer{0u};
+                    auto dict           = byte_dict_type{};
+
+                    arena.offsets.resize(inps.size() + 1);
+                    arena.offsets[0] = 0u;
+
+                    for (size_t i = 0u; i < inps.size(); ++i){
+                        bufs[i]                 = inps[i].data();
+                        lens[i]                 = inps[i].size();
+                        arena.offsets[i + 1]    = arena.offsets[i] + this->encoded_size(inps[i].size());
+                    }
+
+                    arena.buf.resize(arena.offsets.back());
+
+                    if (!is_keyed){
+                        dg::hasher::murmur_hash_many(bufs.data(), lens.data(), inps.size(), this->integrity_secret, keys.data());
+                    }
+
+                    for (size_t i = 0u; i < inps.size(); ++i){
+                        auto out        = std::span<char>(arena.buf.data() + arena.offsets[i], arena.offsets[i + 1] - arena.offsets[i]);
+                        uint64_t salt   = this->salt_gen->get();
+                        randomizer.seed(this->seeder.seed(salt));
+
+                        if (is_keyed){
+                            this->encode_keyed_frame(std::span<const char>(inps[i]), out, salt, randomizer, dict);
+                        } else{
+                            this->encode_frame(std::span<const char>(inps[i]), out, keys[i], salt, randomizer, dict);
+                        }
+                    }
+                } catch (...){
+                    arena.clear();
+                    throw;
+                }
+            }
+
+            void decode_batch(std::span<const std::string_view> inps, OutputArena& arena){
+
+                try{
+                    auto randomizer     = Randomizer{0u};
+                    auto dict           = byte_dict_type{};
+                    auto inverse_dict   = byte_dict_type{};
+                    size_t cap          = 0u;
+
+                    for (const auto& inp: inps){
+                        cap += this->max_decoded_size(inp.size());
+                    }
+
+                    arena.buf.resize(cap);
+                    arena.offsets.resize(inps.size() + 1);
+                    arena.offsets[0] = 0u;
+
+                    for (size_t i = 0u; i < inps.size(); ++i){
+                        auto out                = std::span<char>(arena.buf.data() + arena.offsets[i], cap - arena.offsets[i]);
+                        randomizer.seed(this->seeder.seed(this->read_salt(std::span<const char>(inps[i]))));
+                        arena.offsets[i + 1]    = arena.offsets[i] + this->decode_frame(std::span<const char>(inps[i]), out, randomizer, dict, inverse_dict);
+                    }
+                } catch (...){
+                    arena.clear();
+                    throw;
+                }
+            }
+
+            auto encoded_size(size_t sz) const noexcept -> size_t{
+
+                if (this->format == constants::MURMUR_KEYED_FORMAT){
+                    return SALT_SIZE + KEYED_HEADER_SIZE + sz + TRAILER_SIZE;
+                }
+
+                return SALT_SIZE + HEADER_SIZE + sz + TRAILER_SIZE;
+            }
+
+            //upper bound over both accepted frames
+            auto max_decoded_size(size_t sz) const noexcept -> size_t{
+
+                return sz < SALT_SIZE + KEYED_HEADER_SIZE + TRAILER_SIZE ? 0u : sz - (SALT_SIZE + KEYED_HEADER_SIZE + TRAILER_SIZE);
+            }
+
+        protected:
+
+            //randomizer is expected to be seeded from salt
+            auto encode_frame(std::span<const char> inp, std::span<char> out, uint64_t key, uint64_t salt, Randomizer& randomizer, byte_dict_type& dict) const noexcept -> size_t{
+
+                size_t sz           = this->encoded_size(inp.size());
+                auto header         = std::array<char, HEADER_SIZE>{};
+                auto trailer        = std::array<char, TRAILER_SIZE>{};
+                uint64_t h1         = INTEGRITY_SEED;
+                uint64_t h2         = INTEGRITY_SEED;
+                char * last         = dg::trivial_serializer::serialize_into(out.data(), salt);
+
+                dg::compact_serializer::serialize_into(dg::compact_serializer::serialize_into(header.data(), key), static_cast<size_type>(inp.size()));
+                dg::hasher::murmur_block(h1, h2, header.data());
+                last = this->encode_bytes(header.data(), header.size(), last, dict, randomizer);
+
+                const size_t nblocks = inp.size() / BLOCK_SIZE;
+
+                for (size_t i = 0u; i < nblocks; ++i){
+                    dg::hasher::murmur_block(h1, h2, inp.data() + i * BLOCK_SIZE);
+                    last = this->encode_bytes(inp.data() + i * BLOCK_SIZE, BLOCK_SIZE, last, dict, randomizer);
+                }
+
+                const char * tail       = inp.data() + nblocks * BLOCK_SIZE;
+                const size_t tail_sz    = inp.size() - nblocks * BLOCK_SIZE;
+
+                dg::hasher::murmur_tail(h1, h2, tail, tail_sz);
+                last = this->encode_bytes(tail, tail_sz, last, dict, randomizer);
+
+                dg::compact_serializer::serialize_into(trailer.data(), dg::hasher::murmur_finalize(h1, h2, HEADER_SIZE + inp.size()));
+                this->encode_bytes(trailer.data(), trailer.size(), last, dict, randomizer);
+
+                return sz;
+            }
+
+            //randomizer is expected to be seeded from salt
+            auto encode_keyed_frame(std::span<const char> inp, std::span<char> out, uint64_t salt, Randomizer& randomizer, byte_dict_type& dict) const noexcept -> size_t{
+
+                size_t sz           = SALT_SIZE + KEYED_HEADER_SIZE + inp.size() + TRAILER_SIZE;
+                auto header         = std::array<char, KEYED_HEADER_SIZE>{};
+                auto trailer        = std::array<char, TRAILER_SIZE>{};
+                auto integrity      = dg::hasher::MurmurState(this->integrity_secret);
+                char * last         = dg::trivial_serializer::serialize_into(out.data(), salt);
+
+                dg::compact_serializer::serialize_into(dg::compact_serializer::serialize_into(header.data(), constants::MURMUR_KEYED_FORMAT), static_cast<size_type>(inp.size()));
+                integrity.update(header.data(), header.size());
+                last = this->encode_bytes(header.data(), header.size(), last, dict, randomizer);
+
+                for (size_t first = 0u; first < inp.size(); first += BLOCK_SIZE){
+                    size_t block_sz = std::min(BLOCK_SIZE, inp.size() - first);
+                    integrity.update(inp.data() + first, block_sz);
+                    last = this->encode_bytes(inp.data() + first, block_sz, last, dict, randomizer);
+                }
+
+                dg::compact_serializer::serialize_into(trailer.data(), integrity.finalize());
+                this->encode_bytes(trailer.data(), trailer.size(), last, dict, randomizer);
+
+                return sz;
+            }
+
+            //the smallest frame of either format - decode_frame checks the legacy size once the header says legacy
+            auto read_salt(std::span<const char> inp) const -> uint64_t{
+
+                if (inp.size() < SALT_SIZE + KEYED_HEADER_SIZE + TRAILER_SIZE){
+                    throw bad_encoding_format();
+                }
+
+                uint64_t salt = {};
+                dg::trivial_serializer::deserialize_into(salt, inp.data());
+
+                return salt;
+            }
+
+            //inp passed read_salt, randomizer is expected to be seeded from that salt
+            auto decode_frame(std::span<const char> inp, std::span<char> out, Randomizer& randomizer, byte_dict_type& dict, byte_dict_type& inverse_dict) const -> size_t{
+
+                const char * first  = inp.data() + SALT_SIZE;
+                auto header         = std::array<char, HEADER_SIZE>{};
+                auto trailer        = std::array<char, TRAILER_SIZE>{};
+                uint64_t key        = {};
+                size_type sz        = {};
+                uint64_t h1         = INTEGRITY_SEED;
+                uint64_t h2         = INTEGRITY_SEED;
+                uint64_t kh1        = static_cast<uint32_t>(this->integrity_secret);
+                uint64_t kh2        = static_cast<uint32_t>(this->integrity_secret);
+
+                first = this->decode_bytes(first, KEYED_HEADER_SIZE, header.data(), dict, inverse_dict, randomizer);
+                dg::compact_serializer::deserialize_into(sz, header.data() + sizeof(uint8_t));
+
+                //a legacy header reads as keyed only if 72 bits of its validation key match - it then fails the keyed hash
+                if (std::bit_cast<uint8_t>(header[0]) == constants::MURMUR_KEYED_FORMAT && sz == inp.size() - (SALT_SIZE + KEYED_HEADER_SIZE + TRAILER_SIZE)){
+                    return this->decode_keyed_payload(first, sz, header, out, randomizer, dict, inverse_dict);
+                }
+
+                if (inp.size() < SALT_SIZE + HEADER_SIZE + TRAILER_SIZE){
+                    throw bad_encoding_format();
+                }
+
+                first = this->decode_bytes(first, HEADER_SIZE - KEYED_HEADER_SIZE, header.data() + KEYED_HEADER_SIZE, dict, inverse_dict, randomizer);
+                dg::compact_serializer::deserialize_into(sz, dg::compact_serializer::deserialize_into(key, header.data()));
+
+                if (sz != inp.size() - (SALT_SIZE + HEADER_SIZE + TRAILER_SIZE)){
+                    throw bad_encoding_format();
+                }
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                dg::hasher::murmur_block(h1, h2, header.data());
+
+                const size_t nblocks = sz / BLOCK_SIZE;
+
+                for (size_t i = 0u; i < nblocks; ++i){
+                    char * block = out.data() + i * BLOCK_SIZE;
+                    first = this->decode_bytes(first, BLOCK_SIZE, block, dict, inverse_dict, randomizer);
+                    dg::hasher::murmur_block(h1, h2, block);
+                    dg::hasher::murmur_block(kh1, kh2, block);
+                }
+
+                char * tail             = out.data() + nblocks * BLOCK_SIZE;
+                const size_t tail_sz    = sz - nblocks * BLOCK_SIZE;
+
+                first = this->decode_bytes(first, tail_sz, tail, dict, inverse_dict, randomizer);
+                dg::hasher::murmur_tail(h1, h2, tail, tail_sz);
+                dg::hasher::murmur_tail(kh1, kh2, tail, tail_sz);
+                this->decode_bytes(first, trailer.size(), trailer.data(), dict, inverse_dict, randomizer);
+
+                auto expected = hash_type{};
+                dg::compact_serializer::deserialize_into(expected, trailer.data());
+
+                if (expected != dg::hasher::murmur_finalize(h1, h2, HEADER_SIZE + sz)){
+                    throw bad_encoding_format();
+                }
+
+                if (key != dg::hasher::murmur_finalize(kh1, kh2, sz)){
+                    throw bad_encoding_format();
+                }
+
+                return sz;
+            }
+
+            //first is the encoded payload after a keyed header, randomizer is at its first byte
+            auto decode_keyed_payload(const char * first, size_type sz, const std::array<char, HEADER_SIZE>& header, std::span<char> out, 
+                                      Randomizer& randomizer, byte_dict_type& dict, byte_dict_type& inverse_dict) const -> size_t{
+
+                auto trailer        = std::array<char, TRAILER_SIZE>{};
+                auto integrity      = dg::hasher::MurmurState(this->integrity_secret);
+                auto expected       = hash_type{};
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                integrity.update(header.data(), KEYED_HEADER_SIZE);
+
+                for (size_t i = 0u; i < sz; i += BLOCK_SIZE){
+                    size_t block_sz = std::min(BLOCK_SIZE, static_cast<size_t>(sz) - i);
+                    first = this->decode_bytes(first, block_sz, out.data() + i, dict, inverse_dict, randomizer);
+                    integrity.update(out.data() + i, block_sz);
+                }
+
+                this->decode_bytes(first, trailer.size(), trailer.data(), dict, inverse_dict, randomizer);
+                dg::compact_serializer::deserialize_into(expected, trailer.data());
+
+                if (expected != integrity.finalize()){
+                    throw bad_encoding_format();
+                }
+
+                return sz;
+            }
+
+            static inline auto encode_bytes(const char * src, size_t sz, char * dst, byte_dict_type& dict, Randomizer& randomizer) noexcept -> char *{
+
+                for (size_t i = 0u; i < sz; ++i){
+                    dst[i] = ByteDictEngine::byte_encode(src[i], dict, randomizer);
+                }
+
+                return dst + sz;
+            }
+
+            static inline auto decode_bytes(const char * src, size_t sz, char * dst, byte_dict_type& dict, byte_dict_type& inverse_dict, Randomizer& randomizer) noexcept -> const char *{
+
+                for (size_t i = 0u; i < sz; ++i){
+                    dst[i] = ByteDictEngine::byte_decode(src[i], dict, inverse_dict, randomizer);
+                }
+
+                return src + sz;
+            }
+    };
+
+    using FusedEncoder = BasicFusedEncoder<mt19937>;
+
+    //the dict of stream position p is a pure function of (seed, p) on the Philox keystream - so the frame can be decoded from any offset and in independent segments
+    //same wire format as BasicFusedEncoder<PhiloxStream> - legacy frame only, decode_range / decode_parallel seek off its fixed HEADER_SIZE
+
+    class PhiloxEncoder: public BasicFusedEncoder<PhiloxStream>{
+
+        private:
+
+            static constexpr size_t MIN_SEGMENT_SIZE = size_t{1} << 12;
+
+        public:
+
+            PhiloxEncoder(uint64_t integrity_secret,
+                          const std::string& secret,
+                          std::unique_ptr<SaltGeneratorInterface> salt_gen): BasicFusedEncoder<PhiloxStream>(integrity_secret, secret, std::move(salt_gen)){}
+
+            PhiloxEncoder(uint64_t integrity_secret,
+                          const std::string& secret,
+                          mt19937 salt_randgen): BasicFusedEncoder<PhiloxStream>(integrity_secret, secret, std::move(salt_randgen)){}
+
+            using BasicFusedEncoder<PhiloxStream>::decode;
+
+            auto decode_range(const std::string& arg, size_t offset, size_t len) const -> std::string{
+
+                auto rs = std::string(len, ' ');
+                this->decode_range(std::span<const char>(arg), offset, std::span<char>(rs));
+
+                return rs;
+            }
+
+            //out = payload[offset, offset + out.size()) - the header is checked, the payload is NOT authenticated (the integrity hash covers the whole payload), use decode when that matters
+            void decode_range(std::span<const char> inp, size_t offset, std::span<char> out) const{
+
+                auto randomizer     = PhiloxStream{this->seeder.seed(this->read_salt(inp))};
+                auto dict           = byte_dict_type{};
+                auto inverse_dict   = byte_dict_type{};
+                size_type sz        = this->read_header(inp, randomizer, dict, inverse_dict).second;
+
+                if (offset > sz || out.size() > sz - offset){
+                    throw invalid_argument();
+                }
+
+                randomizer.seek((HEADER_SIZE + offset) * ByteDictEngine::DRAWS_PER_BYTE);
+                this->decode_bytes(inp.data() + SALT_SIZE + HEADER_SIZE + offset, out.size(), out.data(), dict, inverse_dict, randomizer);
+            }
+
+            //decode split across up to thread_count threads (segments of at least MIN_SEGMENT_SIZE), hashes are checked over the joined output
+            //inp and out must not overlap - overlapping spans fall back to the sequential decode
+            auto decode_parallel(std::span<const char> inp, std::span<char> out, size_t thread_count) -> size_t{
+
+                if (inp.data() < out.data() + out.size() && out.data() < inp.data() + inp.size()){
+                    return this->decode(inp, out);
+                }
+
+                uint64_t seed       = this->seeder.seed(this->read_salt(inp));
+                auto randomizer     = PhiloxStream{seed};
+                auto dict           = byte_dict_type{};
+                auto inverse_dict   = byte_dict_type{};
+                auto [header, sz]   = this->read_header(inp, randomizer, dict, inverse_dict);
+                auto trailer        = std::array<char, TRAILER_SIZE>{};
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                size_t segment_count    = std::clamp(static_cast<size_t>(sz / MIN_SEGMENT_SIZE), size_t{1}, std::max(thread_count, size_t{1}));
+                size_t segment_size     = (sz + segment_count - 1) / segment_count;
+                auto workers            = std::vector<std::jthread>{};
+                const char * payload    = inp.data() + SALT_SIZE + HEADER_SIZE;
+
+                workers.reserve(segment_count - 1);
+
+                auto decode_segment = [=, this](size_t idx, PhiloxStream& randomizer, byte_dict_type& dict, byte_dict_type& inverse_dict){
+                    size_t first    = std::min(static_cast<size_t>(sz), idx * segment_size);
+                    size_t last     = std::min(static_cast<size_t>(sz), first + segment_size);
+                    randomizer.seek((HEADER_SIZE + first) * ByteDictEngine::DRAWS_PER_BYTE);
+                    this->decode_bytes(payload + first, last - first, out.data() + first, dict, inverse_dict, randomizer);
+                };
+
+                for (size_t i = 1u; i < segment_count; ++i){
+                    workers.emplace_back([=]{
+                        auto randomizer     = PhiloxStream{seed};
+                        auto dict           = byte_dict_type{};
+                        auto inverse_dict   = byte_dict_type{};
+                        decode_segment(i, randomizer, dict, inverse_dict);
+                    });
+                }
+
+                decode_segment(0u, randomizer, dict, inverse_dict);
+                randomizer.seek((HEADER_SIZE + sz) * ByteDictEngine::DRAWS_PER_BYTE);
+                this->decode_bytes(payload + sz, trailer.size(), trailer.data(), dict, inverse_dict, randomizer);
+                workers.clear();
+
+                auto integrity_state    = dg::hasher::MurmurState(INTEGRITY_SEED);
+                auto expected           = hash_type{};
+                uint64_t key            = {};
+
+                integrity_state.update(header.data(), header.size());
+                integrity_state.update(out.data(), sz);
+                dg::compact_serializer::deserialize_into(expected, trailer.data());
+                dg::compact_serializer::deserialize_into(key, header.data());
+
+                if (expected != integrity_state.finalize()){
+                    throw bad_encoding_format();
+                }
+
+                if (key != dg::hasher::murmur_hash(out.data(), sz, this->integrity_secret)){
+                    throw bad_encoding_format();
+                }
+
+                return sz;
+            }
+
+        private:
+
+            //inp passed read_salt, randomizer is expected to be seeded from that salt and at draw 0
+            auto read_header(std::span<const char> inp, PhiloxStream& randomizer, byte_dict_type& dict, byte_dict_type& inverse_dict) const -> std::pair<std::array<char, HEADER_SIZE>, size_type>{
+
+                auto header     = std::array<char, HEADER_SIZE>{};
+                uint64_t key    = {};
+                size_type sz    = {};
+
+                if (inp.size() < SALT_SIZE + HEADER_SIZE + TRAILER_SIZE){
+                    throw bad_encoding_format();
+                }
+
+                this->decode_bytes(inp.data() + SALT_SIZE, header.size(), header.data(), dict, inverse_dict, randomizer);
+                dg::compact_serializer::deserialize_into(sz, dg::compact_serializer::deserialize_into(key, header.data()));
+
+                if (sz != inp.size() - (SALT_SIZE + HEADER_SIZE + TRAILER_SIZE)){
+                    throw bad_encoding_format();
+                }
+
+                return {header, sz};
+            }
+    };
+
+    //{format tag, frame...} - encode writes the frame of encode_tag, decode dispatches on the tag (bad_encoding_format if nothing is registered for it)
+    //decode(in, out) with in.data() == out.data() leaves out one byte behind the frame - fine for the registered frames, which never write ahead of their read cursor
+
+    class VersionedEncoder: public virtual EncoderInterface{
+
+        private:
+
+            static constexpr size_t TAG_SIZE = sizeof(uint8_t);
+
+            std::array<std::unique_ptr<EncoderInterface>, 256> encoders;
+            std::vector<uint8_t> tags;
+            uint8_t encode_tag;
+
+        public:
+
+            VersionedEncoder(uint8_t encode_tag,
+                             std::vector<std::pair<uint8_t, std::unique_ptr<EncoderInterface>>> encoders): encoders(), 
+                                                                                                           tags(),
+                                                                                                           encode_tag(encode_tag){
+
+                for (auto& [tag, encoder]: encoders){
+                    if (!encoder || this->encoders[tag]){
+                        throw invalid_argument();
+                    }
+
+                    this->encoders[tag] = std::move(encoder);
+                    this->tags.push_back(tag);
+                }
+
+                if (!this->encoders[encode_tag]){
+                    throw invalid_argument();
+                }
+            }
+
+            auto encode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->encoded_size(arg.size()), ' ');
+                this->encode(std::span<const char>(arg), std::span<char>(rs));
+
+                return rs;
+            }
+
+            auto decode(const std::string& arg) -> std::string{
+
+                auto rs = std::string(this->max_decoded_size(arg.size()), ' ');
+                rs.resize(this->decode(std::span<const char>(arg), std::span<char>(rs)));
+
+                return rs;
+            }
+
+            auto encode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t sz = this->encoded_size(inp.size());
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                this->encoders[this->encode_tag]->encode(inp, out.subspan(TAG_SIZE));
+                out[0] = std::bit_cast<char>(this->encode_tag);
+
+                return sz;
+            }
+
+            auto decode(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                if (inp.size() < TAG_SIZE){
+                    throw bad_encoding_format();
+                }
+
+                const auto& encoder = this->encoders[std::bit_cast<uint8_t>(inp[0])];
+
+                if (!encoder){
+                    throw bad_encoding_format();
+                }
+
+                return encoder->decode(inp.subspan(TAG_SIZE), out);
+            }
+
+            auto encoded_size(size_t sz) const noexcept -> size_t{
+
+                return TAG_SIZE + this->encoders[this->encode_tag]->encoded_size(sz);
+            }
+
+            auto max_decoded_size(size_t sz) const noexcept -> size_t{
+
+                size_t rs = 0u;
+
+                if (sz < TAG_SIZE){
+                    return rs;
+                }
+
+                for (uint8_t tag: this->tags){
+                    rs = std::max(rs, this->encoders[tag]->max_decoded_size(sz - TAG_SIZE));
+                }
+
+                return rs;
+            }
+    };
+
+    //streaming frame - {salt, E(record_0), E(tag_0), ..., E(record_n), E(tag_n)} where E is the salted mt19937 substitution stream
+    //every record but the last carries exactly RECORD_SIZE payload bytes, the last one carries 0..RECORD_SIZE-1 - tag_i = murmur_hash128(record_i, record index, is_last, integrity_secret)[0]
+    //the index and the last flag in the tag catch dropped, reordered and truncated records - this is not the spawn_encoder wire format
+    //peak memory is the session state (one mt19937 + two dicts) plus one record on the decode side, whatever the payload size
+
+    struct StreamRecord{
+
+        static constexpr size_t RECORD_SIZE = size_t{1} << 16;
+        static constexpr size_t TAG_SIZE    = sizeof(uint64_t);
+
+        //state has absorbed the record payload
+        static inline auto tag(dg::hasher::MurmurState state, uint64_t record_idx, bool is_last) noexcept -> std::array<char, TAG_SIZE>{
+
+            auto suffix = std::array<char, sizeof(uint64_t) + sizeof(uint8_t)>{};
+            auto rs     = std::array<char, TAG_SIZE>{};
+
+            dg::trivial_serializer::serialize_into(dg::trivial_serializer::serialize_into(suffix.data(), record_idx), static_cast<uint8_t>(is_last));
+            state.update(suffix.data(), suffix.size());
+            dg::trivial_serializer::serialize_into(rs.data(), state.finalize());
+
+            return rs;
+        }
+    };
+
+    class EncoderSession{
+
+        private:
+
+            static constexpr size_t SALT_SIZE       = sizeof(uint64_t);
+            static constexpr size_t RECORD_SIZE     = StreamRecord::RECORD_SIZE;
+            static constexpr size_t TAG_SIZE        = StreamRecord::TAG_SIZE;
+
+            uint64_t integrity_secret;
+            dg::hasher::MurmurState record_hasher;
+            uint64_t record_idx;
+            size_t record_sz;
+            uint64_t salt;
+            mt19937 randomizer;
+            byte_dict_type dict;
+            bool salt_emitted;
+
+        public:
+
+            EncoderSession(uint64_t integrity_secret, const SaltedSeeder& seeder, uint64_t salt) noexcept: integrity_secret(integrity_secret),
+                                                                                                            record_hasher(integrity_secret),
+                                                                                                            record_idx(0u),
+                                                                                                            record_sz(0u),
+                                                                                                            salt(salt),
+                                                                                                            randomizer(seeder.seed(salt)),
+                                                                                                            dict(),
+                                                                                                            salt_emitted(false){}
+
+            //bytes the next update(sz bytes) writes - the payload plus a tag for every record it completes
+            auto update_size(size_t sz) const noexcept -> size_t{
+
+                size_t tag_sz = ((this->record_sz + sz) / RECORD_SIZE) * TAG_SIZE;
+                return this->salt_emitted ? sz + tag_sz : SALT_SIZE + sz + tag_sz;
+            }
+
+            auto finalize_size() const noexcept -> size_t{
+
+                return this->salt_emitted ? TAG_SIZE : SALT_SIZE + TAG_SIZE;
+            }
+
+            auto update(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                size_t sz = this->update_size(inp.size());
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                char * last = this->emit_salt(out.data());
+
+                while (!inp.empty()){
+                    size_t chunk_sz = std::min(inp.size(), RECORD_SIZE - this->record_sz);
+                    this->record_hasher.update(inp.data(), chunk_sz);
+                    last            = this->encode_bytes(inp.data(), chunk_sz, last);
+                    this->record_sz += chunk_sz;
+                    inp             = inp.subspan(chunk_sz);
+
+                    if (this->record_sz == RECORD_SIZE){
+                        last = this->emit_tag(last, false);
+                    }
+                }
+
+                return sz;
+            }
+
+            auto finalize(std::span<char> out) -> size_t{
+
+                size_t sz = this->finalize_size();
+
+                if (out.size() < sz){
+                    throw invalid_argument();
+                }
+
+                this->emit_tag(this->emit_salt(out.data()), true);
+                return sz;
+            }
+
+        private:
+
+            auto emit_salt(char * buf) noexcept -> char *{
+
+                if (this->salt_emitted){
+                    return buf;
+                }
+
+                this->salt_emitted = true;
+                return dg::trivial_serializer::serialize_into(buf, this->salt);
+            }
+
+            auto emit_tag(char * buf, bool is_last) noexcept -> char *{
+
+                auto tag            = StreamRecord::tag(this->record_hasher, this->record_idx, is_last);
+                this->record_hasher = dg::hasher::MurmurState(this->integrity_secret);
+                this->record_idx    += 1u;
+                this->record_sz     = 0u;
+
+                return this->encode_bytes(tag.data(), tag.size(), buf);
+            }
+
+            auto encode_bytes(const char * src, size_t sz, char * dst) noexcept -> char *{
+
+                for (size_t i = 0u; i < sz; ++i){
+                    dst[i] = ByteDictEngine::byte_encode(src[i], this->dict, this->randomizer);
+                }
+
+                return dst + sz;
+            }
+    };
+
+    //update() / finalize() only ever hand out payload of records whose tag checked - a tampered or truncated record throws bad_encoding_format before any of its bytes reach out
+    //update() holds back the record in progress, out must hold update_size(inp.size()) bytes - a session that threw stays failed
+
+    class DecoderSession{
+
+        private:
+
+            static constexpr size_t SALT_SIZE       = sizeof(uint64_t);
+            static constexpr size_t RECORD_SIZE     = StreamRecord::RECORD_SIZE;
+            static constexpr size_t TAG_SIZE        = StreamRecord::TAG_SIZE;
+
+            uint64_t integrity_secret;
+            SaltedSeeder seeder;
+            std::optional<mt19937> randomizer;
+            byte_dict_type dict;
+            byte_dict_type inverse_dict;
+            std::array<char, SALT_SIZE> salt;
+            size_t salt_sz;
+            std::vector<char> record;
+            uint64_t record_idx;
+            bool is_failed;
+
+        public:
+
+            DecoderSession(uint64_t integrity_secret, SaltedSeeder seeder): integrity_secret(integrity_secret),
+                                                                            seeder(std::move(seeder)),
+                                                                            randomizer(std::nullopt),
+                                                                            dict(),
+                                                                            inverse_dict(),
+                                                                            salt(),
+                                                                            salt_sz(0u),
+                                                                            record(),
+                                                                            record_idx(0u),
+                                                                            is_failed(false){
+
+                this->record.reserve(RECORD_SIZE + TAG_SIZE);
+            }
+
+            //upper bound of the bytes the next update(sz bytes) writes - the full records it completes
+            auto update_size(size_t sz) const noexcept -> size_t{
+
+                return ((this->record.size() + sz) / (RECORD_SIZE + TAG_SIZE)) * RECORD_SIZE;
+            }
+
+            //upper bound of the bytes finalize() writes
+            auto finalize_size() const noexcept -> size_t{
+
+                return this->record.size() > TAG_SIZE ? this->record.size() - TAG_SIZE : 0u;
+            }
+
+            auto update(std::span<const char> inp, std::span<char> out) -> size_t{
+
+                if (this->is_failed){
+                    throw bad_encoding_format();
+                }
+
+                if (out.size() < this->update_size(inp.size())){
+                    throw invalid_argument();
+                }
+
+                if (!this->randomizer){
+                    size_t fill_sz = std::min(inp.size(), SALT_SIZE - this->salt_sz);
+                    std::memcpy(this->salt.data() + this->salt_sz, inp.data(), fill_sz);
+                    this->salt_sz   += fill_sz;
+                    inp             = inp.subspan(fill_sz);
+
+                    if (this->salt_sz != SALT_SIZE){
+                        return 0u;
+                    }
+
+                    uint64_t salt = {};
+                    dg::trivial_serializer::deserialize_into(salt, this->salt.data());
+                    this->randomizer.emplace(this->seeder.seed(salt));
+                }
+
+                size_t rs = 0u;
+
+                while (!inp.empty()){
+                    size_t first    = this->record.size();
+                    size_t chunk_sz = std::min(inp.size(), RECORD_SIZE + TAG_SIZE - first);
+                    this->record.resize(first + chunk_sz);
+                    this->decode_bytes(inp.data(), chunk_sz, this->record.data() + first);
+                    inp             = inp.subspan(chunk_sz);
+
+                    //a full record followed by its tag is never the last one - the last record is shorter than RECORD_SIZE
+                    if (this->record.size() == RECORD_SIZE + TAG_SIZE){
+                        rs += this->release_record(RECORD_SIZE, false, out.data() + rs);
+                    }
+                }
+
+                return rs;
+            }
+
+            //authenticates the last record and writes its payload - throws bad_encoding_format if the stream was truncated, tampered with or has trailing bytes
+            auto finalize(std::span<char> out) -> size_t{
+
+                if (this->is_failed || !this->randomizer || this->record.size() < TAG_SIZE){
+                    this->is_failed = true;
+                    throw bad_encoding_format();
+                }
+
+                if (out.size() < this->finalize_size()){
+                    throw invalid_argument();
+                }
+
+                return this->release_record(this->record.size() - TAG_SIZE, true, out.data());
+            }
+
+        private:
+
+            void decode_bytes(const char * src, size_t sz, char * dst) noexcept{
+
+                for (size_t i = 0u; i < sz; ++i){
+                    dst[i] = ByteDictEngine::byte_decode(src[i], this->dict, this->inverse_dict, *this->randomizer);
+                }
+            }
+
+            //record holds sz payload bytes followed by the tag
+            auto release_record(size_t sz, bool is_last, char * dst) -> size_t{
+
+                auto state = dg::hasher::MurmurState(this->integrity_secret);
+                state.update(this->record.data(), sz);
+                auto tag   = StreamRecord::tag(state, this->record_idx, is_last);
+
+                if (!std::equal(tag.begin(), tag.end(), this->record.data() + sz)){
+                    this->is_failed = true;
+                    throw bad_encoding_format();
+                }
+
+                if (sz != 0u){
+                    std::memcpy(dst, this->record.data(), sz);
+                }
+
+                this->record.clear();
+                this->record_idx += 1u;
+
+                return sz;
+            }
+    };
+
+    class StreamingEncoder{
+
+        private:
+
+            uint64_t integrity_secret;
+            SaltedSeeder seeder;
+            std::unique_ptr<SaltGeneratorInterface> salt_gen;
+
+        public:
+
+            StreamingEncoder(uint64_t integrity_secret,
+                             const std::string& secret,
+                             std::unique_ptr<SaltGeneratorInterface> salt_gen) noexcept: integrity_secret(integrity_secret),
+                                                                                         seeder(secret),
+                                                                                         salt_gen(std::move(salt_gen)){}
+
+            auto encode_session() -> EncoderSession{
+
+                return EncoderSession(this->integrity_secret, this->seeder, this->salt_gen->get());
+            }
+
+            auto decode_session() const -> DecoderSession{
+
+                return DecoderSession(this->integrity_secret, this->seeder);
+            }
+    };
+
+    inline auto spawn_salt_generator() -> std::unique_ptr<SaltGeneratorInterface>{
+
+        auto salt_seed_gen      = std::random_device{};
+        uint64_t salt_seed      = (static_cast<uint64_t>(salt_seed_gen()) << 32) | static_cast<uint64_t>(salt_seed_gen());
+
+        return std::make_unique<AtomicSaltGenerator>(salt_seed);
+    }
+
+    //the returned encoder is safe to share across threads - salts come from a lock-free AtomicSaltGenerator
+    //encodes the legacy frame every deployed reader takes, decodes keyed frames as well
+    inline auto spawn_encoder(const std::string& secret) -> std::unique_ptr<EncoderInterface>{
+
+        uint64_t uint_secret = dg::hasher::murmur_hash(secret.data(), secret.size());
+        return std::make_unique<FusedEncoder>(uint_secret, secret, spawn_salt_generator());
+    }
+
+    //spawn_encoder writing the keyed frame (one integrity hash pass) - only once every reader decodes MURMUR_KEYED_FORMAT, older readers reject it
+    inline auto spawn_keyed_encoder(const std::string& secret) -> std::unique_ptr<EncoderInterface>{
+
+        uint64_t uint_secret = dg::hasher::murmur_hash(secret.data(), secret.size());
+        return std::make_unique<FusedEncoder>(uint_secret, secret, spawn_salt_generator(), constants::MURMUR_KEYED_FORMAT);
+    }
+
+    inline auto spawn_streaming_encoder(const std::string& secret) -> std::unique_ptr<StreamingEncoder>{
+
+        uint64_t uint_secret = dg::hasher::murmur_hash(secret.data(), secret.size());
+        return std::make_unique<StreamingEncoder>(uint_secret, secret, spawn_salt_generator());
+    }
+
+    //MurMurEncoder (keyed format) for integrity + BlockPermutationEncoder - the GB/s path, see BlockPermutationEncoder for what it gives up
+    inline auto spawn_block_encoder(const std::string& secret, size_t block_size = BlockPermutationEncoder::DEFAULT_BLOCK_SIZE) -> std::unique_ptr<EncoderInterface>{
+
+        uint64_t uint_secret = dg::hasher::murmur_hash(secret.data(), secret.size());
+        return std::make_unique<DoubleEncoder>(std::make_unique<MurMurEncoder>(uint_secret, constants::MURMUR_KEYED_FORMAT),
+                                               std::make_unique<BlockPermutationEncoder>(secret, spawn_salt_generator(), block_size));
+    }
+
+    //SegmentedEncoder - large messages encoded / decoded across thread_count workers, integrity included (keyed hash per segment), a dict per byte (Mt19937Encoder strength)
+    inline auto spawn_segmented_encoder(const std::string& secret, size_t thread_count = std::thread::hardware_concurrency()) -> std::unique_ptr<EncoderInterface>{
+
+        return std::make_unique<SegmentedEncoder>(secret, spawn_salt_generator(), thread_count);
+    }
+
+    //the block-constant mode - equal bytes within a block_size block encode to equal bytes, see WeakBlockConstantDicts
+    inline auto spawn_weak_block_constant_segmented_encoder(const std::string& secret, size_t thread_count = std::thread::hardware_concurrency(), size_t block_size = BlockPermutationEncoder::DEFAULT_BLOCK_SIZE) -> std::unique_ptr<EncoderInterface>{
+
+        return std::make_unique<SegmentedEncoder>(secret, spawn_salt_generator(), WeakBlockConstantDicts{block_size}, thread_count);
+    }
+
+    //tagged frames - encodes with encode_tag, decodes every format in constants
+    inline auto spawn_versioned_encoder(const std::string& secret, uint8_t encode_tag = constants::PHILOX_FORMAT) -> std::unique_ptr<EncoderInterface>{
+
+        uint64_t uint_secret    = dg::hasher::murmur_hash(secret.data(), secret.size());
+        auto encoders           = std::vector<std::pair<uint8_t, std::unique_ptr<EncoderInterface>>>{};
+
+        encoders.emplace_back(constants::MT19937_FORMAT, std::make_unique<FusedEncoder>(uint_secret, secret, spawn_salt_generator()));
+        encoders.emplace_back(constants::PHILOX_FORMAT, std::make_unique<PhiloxEncoder>(uint_secret, secret, spawn_salt_generator()));
 
-        return combined_encoder;
+        return std::make_unique<VersionedEncoder>(encode_tag, std::move(encoders));
     }
 }
 
-#endif
\ No newline at end of file
+#endif
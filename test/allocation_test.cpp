@@ -0,0 +1,92 @@
+#include "ud_sym_encoder.h"
+#include "allocation_counter.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//the pmr paths of ud_sym_encoder + compact_serializer against the global operator new counter - the arena's upstream is null_memory_resource, so running out of it throws instead of quietly calling malloc
+
+namespace{
+
+    using nested_type       = std::unordered_map<uint32_t, std::vector<std::string>>;
+    using pmr_nested_type   = std::pmr::unordered_map<uint32_t, std::pmr::vector<std::pmr::string>>;
+
+    auto nested_object() -> nested_type{
+
+        auto rs = nested_type{};
+
+        for (uint32_t i = 0u; i < 64u; ++i){
+            rs[i] = std::vector<std::string>(4u, std::string(32u + i, static_cast<char>('a' + i % 26u)));
+        }
+
+        return rs;
+    }
+
+    auto spawn_encoders() -> std::vector<std::unique_ptr<dg::ud_sym_encoder::EncoderInterface>>{
+
+        auto rs = std::vector<std::unique_ptr<dg::ud_sym_encoder::EncoderInterface>>{};
+
+        rs.push_back(dg::ud_sym_encoder::spawn_encoder("my_secret"));
+        rs.push_back(dg::ud_sym_encoder::spawn_block_encoder("my_secret"));
+        rs.push_back(dg::ud_sym_encoder::spawn_versioned_encoder("my_secret"));
+
+        return rs;
+    }
+}
+
+//the counter sees the default allocator path - the zero counts below are not vacuous
+TEST(AllocationCounter, CountsDefaultPath){
+
+    auto encoder        = dg::ud_sym_encoder::spawn_encoder("my_secret");
+    std::string enc     = encoder->encode(dg::compact_serializer::serialize(nested_object()));
+    size_t first_count  = dg::allocation_counter::count();
+    auto obj            = nested_type{};
+
+    dg::compact_serializer::deserialize_into(obj, encoder->decode(enc).data());
+    EXPECT_GT(dg::allocation_counter::count(), first_count);
+}
+
+TEST(PmrArena, DecodeAndDeserializeWithoutGlobalAllocation){
+
+    auto expected   = nested_object();
+    auto backing    = std::vector<std::byte>(size_t{1} << 20);
+
+    for (const auto& encoder: spawn_encoders()){
+        std::string enc     = encoder->encode(dg::compact_serializer::serialize(expected));
+        size_t first_count  = dg::allocation_counter::count();
+        auto arena          = std::pmr::monotonic_buffer_resource(backing.data(), backing.size(), std::pmr::null_memory_resource());
+        auto payload        = dg::ud_sym_encoder::decode(*encoder, enc, &arena);
+        auto obj            = pmr_nested_type(&arena);
+
+        dg::compact_serializer::deserialize_into(obj, payload.data());
+        EXPECT_EQ(dg::allocation_counter::count(), first_count);
+        ASSERT_EQ(obj.size(), expected.size());
+
+        for (const auto& [key, value]: expected){
+            ASSERT_EQ(obj.at(key).size(), value.size());
+
+            for (size_t i = 0u; i < value.size(); ++i){
+                EXPECT_EQ(std::string_view(obj.at(key)[i]), value[i]);
+            }
+        }
+    }
+}
+
+TEST(PmrArena, EncodeWithoutGlobalAllocation){
+
+    std::string inp = dg::compact_serializer::serialize(nested_object());
+    auto backing    = std::vector<std::byte>(size_t{1} << 20);
+
+    for (const auto& encoder: spawn_encoders()){
+        size_t first_count  = dg::allocation_counter::count();
+        auto arena          = std::pmr::monotonic_buffer_resource(backing.data(), backing.size(), std::pmr::null_memory_resource());
+        auto enc            = dg::ud_sym_encoder::encode(*encoder, inp, &arena);
+
+        EXPECT_EQ(dg::allocation_counter::count(), first_count);
+        EXPECT_EQ(encoder->decode(std::string(enc)), inp);
+    }
+}
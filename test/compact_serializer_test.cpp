@@ -0,0 +1,424 @@
+#include "compact_serializer.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace{
+
+    //fixed layout - arithmetic, bool and tuple fields only, constexpr dg_reflect
+    struct FixedMessage{
+        uint32_t id;
+        bool flag;
+        std::tuple<uint16_t, int64_t> pair;
+        double value;
+
+        template <class Reflector>
+        constexpr void dg_reflect(const Reflector& reflector) const{
+            reflector(id, flag, pair, value);
+        }
+
+        template <class Reflector>
+        constexpr void dg_reflect(const Reflector& reflector){
+            reflector(id, flag, pair, value);
+        }
+
+        auto operator==(const FixedMessage&) const -> bool = default;
+    };
+
+    //dynamic layout around fixed elements
+    struct BatchMessage{
+        uint64_t key;
+        std::vector<FixedMessage> items;
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector) const{
+            reflector(key, items);
+        }
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector){
+            reflector(key, items);
+        }
+
+        auto operator==(const BatchMessage&) const -> bool = default;
+    };
+
+    static constexpr size_t FIXED_SIZE          = sizeof(uint32_t) + sizeof(bool) + sizeof(uint16_t) + sizeof(int64_t) + sizeof(double);
+    static constexpr size_t FLAG_OFFSET         = sizeof(uint32_t);
+
+    auto fixed_message(uint32_t id = 7u) -> FixedMessage{
+
+        return FixedMessage{id, true, {0xBEEFu, -42}, 3.5};
+    }
+
+    auto batch_message() -> BatchMessage{
+
+        return BatchMessage{0x0123456789ABCDEFu, {fixed_message(1u), fixed_message(2u), fixed_message(3u)}};
+    }
+}
+
+TEST(StaticSize, MatchesWireSize){
+
+    static_assert(dg::compact_serializer::static_size<FixedMessage>() == FIXED_SIZE);
+    EXPECT_EQ(dg::compact_serializer::size(fixed_message()), FIXED_SIZE);
+    EXPECT_EQ(dg::compact_serializer::serialize(fixed_message()).size(), FIXED_SIZE);
+}
+
+TEST(StaticSize, EveryPathWritesTheSameBytes){
+
+    auto msg            = fixed_message();
+    std::string raw(FIXED_SIZE, ' ');
+    std::string bounded(FIXED_SIZE, ' ');
+
+    dg::compact_serializer::serialize_into(raw.data(), msg);
+    dg::compact_serializer::serialize_into(bounded.data(), bounded.data() + bounded.size(), msg);
+
+    EXPECT_EQ(dg::compact_serializer::serialize(msg), raw);
+    EXPECT_EQ(bounded, raw);
+}
+
+TEST(StaticSize, BoundedRoundtrip){
+
+    auto msg        = batch_message();
+    std::string buf = dg::compact_serializer::serialize(msg);
+    auto rs         = BatchMessage{};
+
+    EXPECT_EQ(dg::compact_serializer::deserialize_into(rs, buf.data(), buf.data() + buf.size()), buf.data() + buf.size());
+    EXPECT_EQ(rs, msg);
+}
+
+TEST(StaticSize, BoundedSinkRejectsShortBuffer){
+
+    std::string buf(FIXED_SIZE - 1u, ' ');
+    EXPECT_THROW(dg::compact_serializer::serialize_into(buf.data(), buf.data() + buf.size(), fixed_message()), dg::compact_serializer::buffer_overflow);
+}
+
+TEST(StaticSize, BoundedSourceRejectsTruncation){
+
+    std::string buf = dg::compact_serializer::serialize(batch_message());
+
+    for (size_t sz = 0u; sz < buf.size(); ++sz){
+        auto rs = BatchMessage{};
+        EXPECT_THROW(dg::compact_serializer::deserialize_into(rs, buf.data(), buf.data() + sz), dg::compact_serializer::bad_encoding_format) << "sz = " << sz;
+    }
+}
+
+//the one-check layout still validates bool bytes
+TEST(StaticSize, BoundedSourceRejectsBadBool){
+
+    std::string buf     = dg::compact_serializer::serialize(fixed_message());
+    buf[FLAG_OFFSET]    = 2;
+    auto rs             = FixedMessage{};
+
+    EXPECT_THROW(dg::compact_serializer::deserialize_into(rs, buf.data(), buf.data() + buf.size()), dg::compact_serializer::bad_encoding_format);
+}
+
+TEST(IntegritySerialize, FixedRoundtrip){
+
+    auto msg        = fixed_message();
+    std::string buf = dg::compact_serializer::integrity_serialize(msg);
+    auto rs         = FixedMessage{};
+
+    EXPECT_EQ(buf.size(), dg::compact_serializer::integrity_size(msg));
+    dg::compact_serializer::integrity_deserialize_into(rs, buf.data(), buf.size());
+    EXPECT_EQ(rs, msg);
+
+    buf[0] ^= 0x01;
+    EXPECT_THROW(dg::compact_serializer::integrity_deserialize_into(rs, buf.data(), buf.size()), dg::compact_serializer::bad_encoding_format);
+}
+
+//the unchecked overload hashes whatever precedes the trailer - a fixed-size T is no exception
+TEST(IntegritySerialize, FixedFrameWithTrailingBytes){
+
+    auto msg            = fixed_message();
+    std::string payload = dg::compact_serializer::serialize(msg) + "tail";
+    std::string buf     = payload;
+    auto rs             = FixedMessage{};
+
+    dg::compact_serializer::serialize_into(buf, dg::compact_serializer::utility::hash(payload.data(), payload.size()));
+    dg::compact_serializer::integrity_deserialize_into(rs, buf.data(), buf.size());
+    EXPECT_EQ(rs, msg);
+}
+
+//serialize_into(std::string&) appends - 15 bytes is the SSO edge, the reserve inside moves the buffer before the sink writes
+TEST(GrowableSink, AppendsAfterReallocatingReserve){
+
+    std::string out(15u, 'x');
+    std::string expected = out + dg::compact_serializer::serialize(uint64_t{0x0102030405060708u});
+
+    dg::compact_serializer::serialize_into(out, uint64_t{0x0102030405060708u});
+    EXPECT_EQ(out, expected);
+}
+
+TEST(GrowableSink, IntegrityAppendsToExistingContent){
+
+    auto msg        = batch_message();
+    std::string out(15u, 'x');
+    std::string buf = dg::compact_serializer::integrity_serialize(msg);
+    auto rs         = BatchMessage{};
+
+    dg::compact_serializer::integrity_serialize_into(out, msg);
+    ASSERT_EQ(out, std::string(15u, 'x') + buf);
+    dg::compact_serializer::integrity_deserialize_into(rs, out.data() + 15u, out.size() - 15u);
+    EXPECT_EQ(rs, msg);
+}
+
+//a fixed-size object that fits the spare capacity is written in place
+TEST(GrowableSink, UsesSpareCapacity){
+
+    std::string out = "abc";
+    out.reserve(256u);
+    const char * data = out.data();
+
+    dg::compact_serializer::serialize_into(out, fixed_message());
+    EXPECT_EQ(out.data(), data);
+    EXPECT_EQ(out.size(), 3u + FIXED_SIZE);
+}
+
+namespace{
+
+    //deserializes buf through the bounded path, padded so the <= 8 byte fast path sees a full word, and expects every byte consumed
+    template <class Format, class T>
+    auto bounded_roundtrip(const std::string& buf) -> T{
+
+        auto rs             = T{};
+        auto padded_rs      = T{};
+        std::string padded  = buf + std::string(sizeof(uint64_t), '\xFF');
+
+        EXPECT_EQ(dg::compact_serializer::deserialize_into<Format>(rs, buf.data(), buf.data() + buf.size()), buf.data() + buf.size());
+        EXPECT_EQ(dg::compact_serializer::deserialize_into<Format>(padded_rs, padded.data(), padded.data() + padded.size()), padded.data() + buf.size());
+        EXPECT_EQ(rs, padded_rs);
+
+        return rs;
+    }
+}
+
+//LEB128 sizes at every 7-bit boundary that matters - one byte up to 127, the 8 / 9 byte split at 2^56, 10 bytes for bit 63
+TEST(Varint, UnsignedRoundtripAndExactSize){
+
+    using format = dg::compact_serializer::formats::Varint;
+
+    const auto cases = std::vector<std::pair<uint64_t, size_t>>{{0u, 1u}, {127u, 1u}, {128u, 2u}, {16383u, 2u}, {16384u, 3u},
+                                                                {(uint64_t{1} << 56) - 1u, 8u}, {uint64_t{1} << 56, 9u}, {uint64_t{1} << 63, 10u},
+                                                                {std::numeric_limits<uint64_t>::max(), 10u}};
+
+    for (auto [value, sz]: cases){
+        std::string buf = dg::compact_serializer::serialize<format>(value);
+
+        EXPECT_EQ(dg::compact_serializer::size<format>(value), sz) << "value = " << value;
+        EXPECT_EQ(buf.size(), sz) << "value = " << value;
+        EXPECT_EQ((bounded_roundtrip<format, uint64_t>(buf)), value) << "value = " << value;
+    }
+
+    EXPECT_EQ(dg::compact_serializer::serialize<format>(uint64_t{0u}), std::string("\x00", 1u));
+    EXPECT_EQ(dg::compact_serializer::serialize<format>(uint64_t{127u}), std::string("\x7F"));
+    EXPECT_EQ(dg::compact_serializer::serialize<format>(uint64_t{128u}), std::string("\x80\x01"));
+    EXPECT_EQ(dg::compact_serializer::serialize<format>(std::numeric_limits<uint64_t>::max()), std::string(9u, '\xFF') + "\x01");
+}
+
+TEST(Varint, ZigzagRoundtripAndExactSize){
+
+    using format = dg::compact_serializer::formats::Varint;
+
+    const auto cases = std::vector<std::pair<int64_t, size_t>>{{0, 1u}, {-1, 1u}, {1, 1u}, {-64, 1u}, {64, 2u},
+                                                               {std::numeric_limits<int64_t>::min(), 10u}, {std::numeric_limits<int64_t>::max(), 10u}};
+
+    for (auto [value, sz]: cases){
+        std::string buf = dg::compact_serializer::serialize<format>(value);
+
+        EXPECT_EQ(dg::compact_serializer::size<format>(value), sz) << "value = " << value;
+        EXPECT_EQ(buf.size(), sz) << "value = " << value;
+        EXPECT_EQ((bounded_roundtrip<format, int64_t>(buf)), value) << "value = " << value;
+    }
+
+    EXPECT_EQ(dg::compact_serializer::serialize<format>(int64_t{-1}), std::string("\x01"));
+    EXPECT_EQ(dg::compact_serializer::serialize<format>(int64_t{1}), std::string("\x02"));
+}
+
+//a well-formed varint the target integer cannot hold
+TEST(Varint, RejectsOverRangeValue){
+
+    using format = dg::compact_serializer::formats::Varint;
+
+    auto u16 = uint16_t{};
+    auto u32 = uint32_t{};
+    auto i16 = int16_t{};
+    auto i32 = int32_t{};
+
+    std::string u16_over = dg::compact_serializer::serialize<format>(uint64_t{0x10000u});
+    std::string u32_over = dg::compact_serializer::serialize<format>(uint64_t{1} << 32);
+    std::string i16_over = dg::compact_serializer::serialize<format>(int64_t{-0x8001});
+    std::string i32_over = dg::compact_serializer::serialize<format>(std::numeric_limits<int64_t>::max());
+
+    EXPECT_THROW(dg::compact_serializer::deserialize_into<format>(u16, u16_over.data(), u16_over.data() + u16_over.size()), dg::compact_serializer::bad_encoding_format);
+    EXPECT_THROW(dg::compact_serializer::deserialize_into<format>(u32, u32_over.data(), u32_over.data() + u32_over.size()), dg::compact_serializer::bad_encoding_format);
+    EXPECT_THROW(dg::compact_serializer::deserialize_into<format>(i16, i16_over.data(), i16_over.data() + i16_over.size()), dg::compact_serializer::bad_encoding_format);
+    EXPECT_THROW(dg::compact_serializer::deserialize_into<format>(i32, i32_over.data(), i32_over.data() + i32_over.size()), dg::compact_serializer::bad_encoding_format);
+
+    std::string u16_max = dg::compact_serializer::serialize<format>(uint64_t{0xFFFFu});
+    std::string i16_min = dg::compact_serializer::serialize<format>(int64_t{-0x8000});
+
+    EXPECT_EQ((bounded_roundtrip<format, uint16_t>(u16_max)), 0xFFFFu);
+    EXPECT_EQ((bounded_roundtrip<format, int16_t>(i16_min)), -0x8000);
+}
+
+//a varint cut anywhere before its last byte, a continuation bit on the last byte of the buffer, an 11th byte and a 10th byte past bit 63
+TEST(Varint, RejectsTruncatedAndOverlongVarint){
+
+    using format = dg::compact_serializer::formats::Varint;
+
+    std::string buf = dg::compact_serializer::serialize<format>(std::numeric_limits<uint64_t>::max());
+
+    for (size_t sz = 0u; sz < buf.size(); ++sz){
+        auto rs = uint64_t{};
+        EXPECT_THROW(dg::compact_serializer::deserialize_into<format>(rs, buf.data(), buf.data() + sz), dg::compact_serializer::bad_encoding_format) << "sz = " << sz;
+    }
+
+    for (std::string bad: {std::string("\x80"), std::string(10u, '\x80') + "\x01", std::string(9u, '\xFF') + "\x02"}){
+        auto rs = uint64_t{};
+        EXPECT_THROW(dg::compact_serializer::deserialize_into<format>(rs, bad.data(), bad.data() + bad.size()), dg::compact_serializer::bad_encoding_format) << "sz = " << bad.size();
+    }
+}
+
+//VarintLength - LEB128 length prefixes around the one / two byte split, integers keep their fixed width
+TEST(VarintLength, RoundtripAndExactSize){
+
+    using format = dg::compact_serializer::formats::VarintLength;
+
+    for (auto [len, prefix_sz]: std::vector<std::pair<size_t, size_t>>{{0u, 1u}, {127u, 1u}, {128u, 2u}, {16384u, 3u}}){
+        auto value      = std::string(len, 'x');
+        std::string buf = dg::compact_serializer::serialize<format>(value);
+
+        EXPECT_EQ(dg::compact_serializer::size<format>(value), prefix_sz + len) << "len = " << len;
+        EXPECT_EQ(buf.size(), prefix_sz + len) << "len = " << len;
+        EXPECT_EQ((bounded_roundtrip<format, std::string>(buf)), value) << "len = " << len;
+    }
+
+    EXPECT_EQ(dg::compact_serializer::size<format>(uint64_t{1u}), sizeof(uint64_t));
+    EXPECT_EQ(dg::compact_serializer::size<format>(std::numeric_limits<uint64_t>::max()), sizeof(uint64_t));
+}
+
+TEST(VarintLength, RejectsTruncatedLength){
+
+    using format = dg::compact_serializer::formats::VarintLength;
+
+    std::string buf = dg::compact_serializer::serialize<format>(std::string(16384u, 'x'));
+
+    for (size_t sz: {size_t{0u}, size_t{1u}, size_t{2u}, size_t{3u}, buf.size() - 1u}){
+        auto rs = std::string{};
+        EXPECT_THROW(dg::compact_serializer::deserialize_into<format>(rs, buf.data(), buf.data() + sz), dg::compact_serializer::bad_encoding_format) << "sz = " << sz;
+    }
+}
+
+namespace{
+
+    struct OwnedMessage{
+        uint32_t id;
+        std::string name;
+        std::vector<uint8_t> blob;
+        std::vector<char> bytes;
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector) const{
+            reflector(id, name, blob, bytes);
+        }
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector){
+            reflector(id, name, blob, bytes);
+        }
+    };
+
+    //same wire format as OwnedMessage - every variable field points into the source buffer
+    struct ViewMessage{
+        uint32_t id;
+        std::string_view name;
+        std::span<const std::byte> blob;
+        std::span<const char> bytes;
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector) const{
+            reflector(id, name, blob, bytes);
+        }
+
+        template <class Reflector>
+        void dg_reflect(const Reflector& reflector){
+            reflector(id, name, blob, bytes);
+        }
+    };
+
+    auto owned_message() -> OwnedMessage{
+
+        return OwnedMessage{7u, "view_name", {0x00, 0x01, 0x80, 0xFF}, {'a', 'b', 'c'}};
+    }
+
+    auto is_inside(const void * ptr, const std::string& buf) -> bool{
+
+        return std::less_equal<const void *>{}(buf.data(), ptr) && std::less_equal<const void *>{}(ptr, buf.data() + buf.size());
+    }
+
+    template <class Format>
+    void expect_view_aliases(){
+
+        auto msg        = owned_message();
+        std::string buf = dg::compact_serializer::serialize<Format>(msg);
+        auto view       = ViewMessage{};
+
+        ASSERT_EQ(dg::compact_serializer::deserialize_into<Format>(view, buf.data(), buf.data() + buf.size()), buf.data() + buf.size());
+        EXPECT_EQ(view.id, msg.id);
+        EXPECT_EQ(view.name, msg.name);
+        ASSERT_EQ(view.blob.size(), msg.blob.size());
+        EXPECT_EQ(std::memcmp(view.blob.data(), msg.blob.data(), msg.blob.size()), 0);
+        EXPECT_EQ(std::string_view(view.bytes.data(), view.bytes.size()), std::string_view(msg.bytes.data(), msg.bytes.size()));
+
+        EXPECT_TRUE(is_inside(view.name.data(), buf));
+        EXPECT_TRUE(is_inside(view.blob.data(), buf));
+        EXPECT_TRUE(is_inside(view.bytes.data(), buf));
+        EXPECT_EQ(std::string_view(buf).substr(static_cast<size_t>(view.name.data() - buf.data()), view.name.size()), msg.name);
+
+        EXPECT_EQ(dg::compact_serializer::serialize<Format>(view), buf);
+        EXPECT_EQ(dg::compact_serializer::size<Format>(view), buf.size());
+    }
+}
+
+//string_view and span<const byte-sized> fields deserialize as views into the buffer - no copy, same bytes as the owning types
+TEST(ViewDeserialize, AliasesSourceBuffer){
+
+    expect_view_aliases<dg::compact_serializer::formats::Fixed>();
+    expect_view_aliases<dg::compact_serializer::formats::VarintLength>();
+    expect_view_aliases<dg::compact_serializer::formats::Varint>();
+}
+
+TEST(ViewDeserialize, RejectsTruncatedBuffer){
+
+    std::string buf = dg::compact_serializer::serialize(owned_message());
+
+    for (size_t sz = 0u; sz < buf.size(); ++sz){
+        auto view = ViewMessage{};
+        EXPECT_THROW(dg::compact_serializer::deserialize_into(view, buf.data(), buf.data() + sz), dg::compact_serializer::bad_encoding_format) << "sz = " << sz;
+    }
+}
+
+//a length prefix past the end of the buffer must not produce a view reaching outside it
+TEST(ViewDeserialize, RejectsLengthPastBuffer){
+
+    std::string buf = dg::compact_serializer::serialize(std::string_view("abc"));
+    auto view       = std::string_view{};
+
+    dg::compact_serializer::serialize_into(buf.data(), uint64_t{4u});
+    EXPECT_THROW(dg::compact_serializer::deserialize_into(view, buf.data(), buf.data() + buf.size()), dg::compact_serializer::bad_encoding_format);
+
+    dg::compact_serializer::serialize_into(buf.data(), std::numeric_limits<uint64_t>::max());
+    EXPECT_THROW(dg::compact_serializer::deserialize_into(view, buf.data(), buf.data() + buf.size()), dg::compact_serializer::bad_encoding_format);
+
+    auto bytes = std::span<const std::byte>{};
+    EXPECT_THROW(dg::compact_serializer::deserialize_into(bytes, buf.data(), buf.data() + buf.size()), dg::compact_serializer::bad_encoding_format);
+}
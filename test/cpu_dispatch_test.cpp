@@ -0,0 +1,89 @@
+#include "cpu_dispatch.h"
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <optional>
+#include <string>
+
+namespace{
+
+    //sets DG_UD_SYM_ISA for the scope, puts back whatever was there and the startup selection on exit
+    class ScopedIsaEnv{
+
+        private:
+
+            std::optional<std::string> previous;
+
+        public:
+
+            ScopedIsaEnv(const char * value): previous(){
+
+                if (const char * env = getenv(dg::cpu_dispatch::ISA_ENV); env != nullptr){
+                    this->previous = env;
+                }
+
+                setenv(dg::cpu_dispatch::ISA_ENV, value, 1);
+            }
+
+            ~ScopedIsaEnv() noexcept{
+
+                if (this->previous.has_value()){
+                    setenv(dg::cpu_dispatch::ISA_ENV, this->previous->c_str(), 1);
+                } else{
+                    unsetenv(dg::cpu_dispatch::ISA_ENV);
+                }
+
+                dg::cpu_dispatch::reset_isa();
+            }
+    };
+}
+
+//every level above the cpu, and one past the last enumerator - the active isa is left as it was
+TEST(CpuDispatch, SetIsaAboveDetectedThrows){
+
+    const auto detected = dg::cpu_dispatch::detect_isa();
+    const auto active   = dg::cpu_dispatch::active_isa();
+
+    for (uint8_t level = static_cast<uint8_t>(detected) + 1u; level <= static_cast<uint8_t>(dg::cpu_dispatch::Isa::avx512) + 1u; ++level){
+        EXPECT_THROW(dg::cpu_dispatch::set_isa(static_cast<dg::cpu_dispatch::Isa>(level)), dg::cpu_dispatch::invalid_argument) << "level = " << static_cast<int>(level);
+        EXPECT_EQ(dg::cpu_dispatch::active_isa(), active);
+    }
+}
+
+TEST(CpuDispatch, ResetIsaRestoresStartupSelection){
+
+    for (uint8_t level = 0u; level <= static_cast<uint8_t>(dg::cpu_dispatch::detect_isa()); ++level){
+        dg::cpu_dispatch::set_isa(static_cast<dg::cpu_dispatch::Isa>(level));
+        EXPECT_EQ(dg::cpu_dispatch::active_isa(), static_cast<dg::cpu_dispatch::Isa>(level));
+
+        dg::cpu_dispatch::reset_isa();
+        EXPECT_EQ(dg::cpu_dispatch::active_isa(), dg::cpu_dispatch::startup_isa());
+    }
+
+    if (getenv(dg::cpu_dispatch::ISA_ENV) == nullptr){
+        EXPECT_EQ(dg::cpu_dispatch::active_isa(), dg::cpu_dispatch::detect_isa());
+    }
+}
+
+//DG_UD_SYM_ISA caps the startup selection, values above the cpu are clamped to it, unknown values are ignored
+TEST(CpuDispatch, IsaEnvCapsStartupSelection){
+
+    const auto detected = dg::cpu_dispatch::detect_isa();
+
+    {
+        auto env = ScopedIsaEnv("scalar");
+        dg::cpu_dispatch::reset_isa();
+        EXPECT_EQ(dg::cpu_dispatch::active_isa(), dg::cpu_dispatch::Isa::scalar);
+    }
+
+    {
+        auto env = ScopedIsaEnv("avx512");
+        dg::cpu_dispatch::reset_isa();
+        EXPECT_EQ(dg::cpu_dispatch::active_isa(), detected);
+    }
+
+    {
+        auto env = ScopedIsaEnv("not_an_isa");
+        dg::cpu_dispatch::reset_isa();
+        EXPECT_EQ(dg::cpu_dispatch::active_isa(), detected);
+    }
+}
@@ -0,0 +1,191 @@
+#include "compact_serializer.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+//fuzz target for the checked decode - deserialize_into(obj, first, last, limits) and integrity_deserialize_into(obj, buf, sz, limits) over untrusted bytes
+//data[0] picks the target type, the wire format and the entry point, data[1..] is the frame
+//an input passes if the decode throws bad_encoding_format, or returns inside [first, last] - canonical Fixed frames must also re-serialize to the consumed bytes
+//anything else (a crash, a sanitizer report, another exception) fails - run libFuzzer with -malloc_limit_mb to also catch single allocations past the budget
+
+//libFuzzer:    cmake -DCMAKE_CXX_COMPILER=clang++ -DUD_SYM_LIBFUZZER=ON ... && ./ud_sym_fuzz_deserialize corpus/
+//AFL:          afl-clang-fast++ build, afl-fuzz -i seeds -o out -- ./ud_sym_fuzz_deserialize @@
+//ctest:        no arguments - replays generated seeds and mutations of them
+
+namespace fuzz{
+
+    using vector_string_type    = std::vector<std::string>;
+    using tuple_type            = std::tuple<std::optional<std::string>, std::unique_ptr<std::vector<uint64_t>>, bool, int32_t>;
+    using map_type              = std::map<uint32_t, std::vector<uint16_t>>;
+    using nested_type           = std::unordered_map<std::string, std::set<int64_t>>;
+
+    static constexpr size_t MAX_ALLOCATION  = size_t{1} << 20;
+    static constexpr size_t TYPE_COUNT      = 4u;
+    static constexpr size_t FORMAT_COUNT    = 3u;
+
+    void check(bool cond, const char * what){
+
+        if (!cond){
+            std::fprintf(stderr, "fuzz_deserialize: %s\n", what);
+            std::abort();
+        }
+    }
+
+    template <class Format, class T>
+    void run(const char * first, const char * last, bool is_integrity){
+
+        auto obj    = T{};
+        auto limits = dg::compact_serializer::DecodeLimits{MAX_ALLOCATION};
+
+        try{
+            if (is_integrity){
+                dg::compact_serializer::integrity_deserialize_into<Format>(obj, first, std::distance(first, last), limits);
+                return;
+            }
+
+            const char * rs = dg::compact_serializer::deserialize_into<Format>(obj, first, last, limits);
+            check(first <= rs && rs <= last, "deserialize_into returned outside [first, last]");
+
+            //Fixed frames of these types have one encoding per value - the decoded object re-serializes to exactly the consumed bytes
+            if constexpr(std::is_same_v<Format, dg::compact_serializer::formats::Fixed> && (std::is_same_v<T, vector_string_type> || std::is_same_v<T, tuple_type>)){
+                check(dg::compact_serializer::serialize(obj) == std::string(first, rs), "re-serialized bytes differ from the consumed frame");
+            }
+        } catch (const dg::compact_serializer::bad_encoding_format&){
+        }
+    }
+
+    template <class Format>
+    void run_format(size_t type_idx, const char * first, const char * last, bool is_integrity){
+
+        switch (type_idx){
+            case 0:     run<Format, vector_string_type>(first, last, is_integrity); return;
+            case 1:     run<Format, tuple_type>(first, last, is_integrity); return;
+            case 2:     run<Format, map_type>(first, last, is_integrity); return;
+            default:    run<Format, nested_type>(first, last, is_integrity); return;
+        }
+    }
+
+    void run_one(const uint8_t * data, size_t sz){
+
+        if (sz == 0u){
+            return;
+        }
+
+        size_t type_idx     = data[0] % TYPE_COUNT;
+        size_t format_idx   = (data[0] / TYPE_COUNT) % FORMAT_COUNT;
+        bool is_integrity   = (data[0] & 0x80u) != 0u;
+        const char * first  = reinterpret_cast<const char *>(data + 1);
+        const char * last   = first + (sz - 1u);
+
+        switch (format_idx){
+            case 0:     run_format<dg::compact_serializer::formats::Fixed>(type_idx, first, last, is_integrity); return;
+            case 1:     run_format<dg::compact_serializer::formats::VarintLength>(type_idx, first, last, is_integrity); return;
+            default:    run_format<dg::compact_serializer::formats::Varint>(type_idx, first, last, is_integrity); return;
+        }
+    }
+
+    //valid frames of every type / format / entry point - the replay driver mutates these, they also make a starting corpus
+    template <class Format, class T>
+    void add_seed(std::vector<std::string>& seeds, size_t type_idx, size_t format_idx, const T& obj){
+
+        auto selector = static_cast<char>(type_idx + format_idx * TYPE_COUNT);
+
+        seeds.push_back(selector + dg::compact_serializer::serialize<Format>(obj));
+        seeds.push_back(static_cast<char>(selector | 0x80) + dg::compact_serializer::integrity_serialize<Format>(obj));
+    }
+
+    template <class Format>
+    void add_seeds(std::vector<std::string>& seeds, size_t format_idx){
+
+        auto tuple_obj = tuple_type{std::string("optional"), std::make_unique<std::vector<uint64_t>>(std::vector<uint64_t>{1u, 1u << 20, ~uint64_t{0}}), true, -7};
+
+        add_seed<Format>(seeds, 0u, format_idx, vector_string_type{"", "a", std::string(300u, 'b')});
+        add_seed<Format>(seeds, 1u, format_idx, tuple_obj);
+        add_seed<Format>(seeds, 2u, format_idx, map_type{{1u, {1u, 2u}}, {70000u, {}}});
+        add_seed<Format>(seeds, 3u, format_idx, nested_type{{"k", {-1, 0, 1}}, {"", {}}});
+    }
+
+    auto generate_seeds() -> std::vector<std::string>{
+
+        auto rs = std::vector<std::string>{};
+
+        add_seeds<dg::compact_serializer::formats::Fixed>(rs, 0u);
+        add_seeds<dg::compact_serializer::formats::VarintLength>(rs, 1u);
+        add_seeds<dg::compact_serializer::formats::Varint>(rs, 2u);
+
+        return rs;
+    }
+
+    //byte flips, truncations, and 0xFF runs (huge length prefixes) over the seeds
+    void replay_generated(size_t iteration_count){
+
+        auto seeds      = generate_seeds();
+        auto randgen    = std::mt19937_64{};
+
+        for (const auto& seed: seeds){
+            run_one(reinterpret_cast<const uint8_t *>(seed.data()), seed.size());
+        }
+
+        for (size_t i = 0u; i < iteration_count; ++i){
+            std::string inp = seeds[randgen() % seeds.size()];
+
+            switch (randgen() % 3u){
+                case 0:
+                    for (size_t j = 0u, flip_sz = 1u + randgen() % 4u; j < flip_sz && inp.size() > 1u; ++j){
+                        inp[1u + randgen() % (inp.size() - 1u)] ^= static_cast<char>(1u << (randgen() % 8u));
+                    }
+                    break;
+                case 1:
+                    inp.resize(1u + randgen() % inp.size());
+                    break;
+                default:
+                    if (inp.size() > 1u){
+                        size_t first    = 1u + randgen() % (inp.size() - 1u);
+                        size_t sz       = std::min(inp.size() - first, size_t{1} + randgen() % 9u);
+                        std::fill(inp.begin() + first, inp.begin() + first + sz, static_cast<char>(0xFF));
+                    }
+                    break;
+            }
+
+            run_one(reinterpret_cast<const uint8_t *>(inp.data()), inp.size());
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t * data, size_t sz){
+
+    fuzz::run_one(data, sz);
+    return 0;
+}
+
+#ifndef DG_LIBFUZZER
+
+int main(int argc, char ** argv){
+
+    if (argc == 1){
+        fuzz::replay_generated(200000u);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; ++i){
+        auto file   = std::ifstream(argv[i], std::ios::binary);
+        auto inp    = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        fuzz::run_one(reinterpret_cast<const uint8_t *>(inp.data()), inp.size());
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "hasher.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace{
+
+    auto random_bytes(size_t sz, uint32_t seed) -> std::string{
+
+        auto rs     = std::string(sz, ' ');
+        auto gen    = std::mt19937{seed};
+
+        for (char& c: rs){
+            c = static_cast<char>(gen());
+        }
+
+        return rs;
+    }
+
+    //reference MurmurHash3_x64_128 digests - {h1, h2}, h1 the first 8 bytes of the reference output
+    struct Murmur128Vector{
+        std::string_view inp;
+        uint64_t seed;
+        dg::hasher::hash128_type digest;
+    };
+
+    constexpr std::string_view FOX         = "the quick brown fox jumps over the lazy dog 0123456789";
+    constexpr std::string_view ONE_BLOCK   = "0123456789abcdef";
+    constexpr std::string_view BLOCK_TAIL  = "0123456789abcdefg";
+
+    auto murmur128_vectors() -> std::vector<Murmur128Vector>{
+
+        return {{"", 0u, {0x0000000000000000ull, 0x0000000000000000ull}},
+                {"", 0xFFu, {0xaf9fb88dfcaf0646ull, 0x766f71d1c2b5ada0ull}},
+                {"hello", 0u, {0xcbd8a7b341bd9b02ull, 0x5b1e906a48ae1d19ull}},
+                {ONE_BLOCK, 0xFFu, {0xe89eac973ee42f8aull, 0xe694596bc2e63c5full}},
+                {BLOCK_TAIL, 0xFFu, {0xa43ccaab529d14e7ull, 0x894c46786180a020ull}},
+                {FOX, 0xFFu, {0x372b84f9503f2407ull, 0x53db28348a6b423dull}},
+                {FOX, 0x1c5c01d4129a9321ull, {0x9e27e1eb37eec4c1ull, 0x5454a52d9aacd0caull}}};
+    }
+
+    auto supported_isas() -> std::vector<dg::cpu_dispatch::Isa>{
+
+        auto rs = std::vector<dg::cpu_dispatch::Isa>{};
+
+        for (dg::cpu_dispatch::Isa isa: {dg::cpu_dispatch::Isa::scalar, dg::cpu_dispatch::Isa::sse4, dg::cpu_dispatch::Isa::avx2, dg::cpu_dispatch::Isa::avx512}){
+            if (isa <= dg::cpu_dispatch::detect_isa()){
+                rs.push_back(isa);
+            }
+        }
+
+        return rs;
+    }
+}
+
+//SMHasher's VerificationTest for MurmurHash3_x64_128 - keys {}, {0}, {0, 1}, ... hashed with seed 256 - len, the digests hashed again with seed 0
+TEST(MurmurHash128, SmhasherVerificationValue){
+
+    auto keys       = std::string(256u, ' ');
+    auto digests    = std::string(256u * 16u, ' ');
+
+    for (size_t i = 0u; i < keys.size(); ++i){
+        keys[i] = static_cast<char>(i);
+    }
+
+    for (size_t i = 0u; i < 256u; ++i){
+        auto digest = dg::hasher::murmur_hash128(keys.data(), i, 256u - i);
+        dg::trivial_serializer::serialize_into(dg::trivial_serializer::serialize_into(digests.data() + i * 16u, digest[0]), digest[1]);
+    }
+
+    EXPECT_EQ(static_cast<uint32_t>(dg::hasher::murmur_hash128(digests.data(), digests.size(), 0u)[0]), 0x6384BA69u);
+}
+
+TEST(MurmurHash128, KnownAnswerVectors){
+
+    for (const Murmur128Vector& vec: murmur128_vectors()){
+        EXPECT_EQ(dg::hasher::murmur_hash128(vec.inp.data(), vec.inp.size(), vec.seed), vec.digest) << "inp = " << vec.inp << ", seed = " << vec.seed;
+
+        if (vec.seed <= std::numeric_limits<uint32_t>::max()){
+            EXPECT_EQ(dg::hasher::murmur_hash(vec.inp.data(), vec.inp.size(), static_cast<uint32_t>(vec.seed)), vec.digest[0]) << "inp = " << vec.inp << ", seed = " << vec.seed;
+        }
+    }
+}
+
+//the <LEN, SEED> forms against the same vectors - murmur_hash<LEN, SEED> is murmur_hash128<LEN, SEED>[0]
+TEST(MurmurHash128, CompileTimeLengthMatchesKnownAnswers){
+
+    using fox_len       = std::integral_constant<size_t, FOX.size()>;
+    using block_len     = std::integral_constant<size_t, ONE_BLOCK.size()>;
+    using tail_len      = std::integral_constant<size_t, BLOCK_TAIL.size()>;
+    using default_seed  = std::integral_constant<uint64_t, 0xFF>;
+    using wide_seed     = std::integral_constant<uint64_t, 0x1c5c01d4129a9321ull>;
+
+    EXPECT_EQ(dg::hasher::murmur_hash128(FOX.data(), fox_len{}, default_seed{}), (dg::hasher::hash128_type{0x372b84f9503f2407ull, 0x53db28348a6b423dull}));
+    EXPECT_EQ(dg::hasher::murmur_hash128(FOX.data(), fox_len{}, wide_seed{}), (dg::hasher::hash128_type{0x9e27e1eb37eec4c1ull, 0x5454a52d9aacd0caull}));
+    EXPECT_EQ(dg::hasher::murmur_hash128(ONE_BLOCK.data(), block_len{}), (dg::hasher::hash128_type{0xe89eac973ee42f8aull, 0xe694596bc2e63c5full}));
+    EXPECT_EQ(dg::hasher::murmur_hash128(BLOCK_TAIL.data(), tail_len{}), (dg::hasher::hash128_type{0xa43ccaab529d14e7ull, 0x894c46786180a020ull}));
+
+    EXPECT_EQ(dg::hasher::murmur_hash(FOX.data(), fox_len{}, default_seed{}), 0x372b84f9503f2407ull);
+    EXPECT_EQ(dg::hasher::murmur_hash(FOX.data(), fox_len{}, wide_seed{}), 0x9e27e1eb37eec4c1ull);
+    EXPECT_EQ(dg::hasher::murmur_hash(ONE_BLOCK.data(), block_len{}), 0xe89eac973ee42f8aull);
+    EXPECT_EQ(dg::hasher::murmur_hash(BLOCK_TAIL.data(), tail_len{}), 0xa43ccaab529d14e7ull);
+
+    static_assert(dg::hasher::murmur_hash128(FOX.data(), fox_len{}, default_seed{}) == dg::hasher::hash128_type{0x372b84f9503f2407ull, 0x53db28348a6b423dull});
+    static_assert(dg::hasher::murmur_hash(FOX.data(), fox_len{}, default_seed{}) == 0x372b84f9503f2407ull);
+}
+
+//every length 0..100 cut at every split point, the tail fed again in chunks of 1..17 bytes so blocks are assembled across several update() calls
+TEST(MurmurState, ChunkedMatchesOneShot){
+
+    const std::string data = random_bytes(100u, 2u);
+
+    for (uint64_t seed: {uint64_t{0xFF}, uint64_t{0u}, uint64_t{0x1c5c01d4129a9321ull}}){
+        for (size_t len = 0u; len <= data.size(); ++len){
+            const auto expected = dg::hasher::murmur_hash128(data.data(), len, seed);
+
+            if (seed <= std::numeric_limits<uint32_t>::max()){
+                ASSERT_EQ(expected[0], dg::hasher::murmur_hash(data.data(), len, static_cast<uint32_t>(seed)));
+            }
+
+            for (size_t split = 0u; split <= len; ++split){
+                for (size_t chunk_sz = 1u; chunk_sz <= 17u; chunk_sz += (chunk_sz < 3u) ? 1u : 7u){
+                    auto state = dg::hasher::MurmurState(seed);
+                    state.update(data.data(), split);
+
+                    for (size_t i = split; i < len; i += chunk_sz){
+                        state.update(data.data() + i, std::min(chunk_sz, len - i));
+                    }
+
+                    EXPECT_EQ(state.finalize128(), expected) << "len = " << len << ", split = " << split << ", chunk_sz = " << chunk_sz << ", seed = " << seed;
+                    EXPECT_EQ(state.finalize(), expected[0]) << "len = " << len << ", split = " << split << ", chunk_sz = " << chunk_sz << ", seed = " << seed;
+                }
+            }
+        }
+    }
+}
+
+//a copied state finishes independently of the one it was copied from
+TEST(MurmurState, CopyForksThePrefix){
+
+    const std::string data  = random_bytes(64u, 3u);
+    auto prefix             = dg::hasher::MurmurState{};
+
+    prefix.update(data.data(), 21u);
+
+    for (size_t len = 21u; len <= data.size(); ++len){
+        auto state = prefix;
+        state.update(data.data() + 21u, len - 21u);
+
+        EXPECT_EQ(state.finalize(), dg::hasher::murmur_hash(data.data(), len)) << "len = " << len;
+    }
+
+    EXPECT_EQ(prefix.finalize(), dg::hasher::murmur_hash(data.data(), 21u));
+}
+
+//every dispatch path against the scalar kernel and murmur_hash - each length 0..300 once, batch sizes off the 4 / 8 lane widths, the uint32 seed path
+TEST(MurmurHashMany, MatchesScalarOnEveryIsa){
+
+    constexpr size_t MAX_LEN    = 300u;
+    const std::string data      = random_bytes(MAX_LEN * 2u, 1u);
+
+    auto bufs = std::vector<const char *>{};
+    auto lens = std::vector<size_t>{};
+
+    for (size_t len = 0u; len <= MAX_LEN; ++len){
+        bufs.push_back(data.data() + (len * 7u) % MAX_LEN);
+        lens.push_back(len);
+    }
+
+    for (dg::cpu_dispatch::Isa isa: supported_isas()){
+        dg::cpu_dispatch::set_isa(isa);
+
+        for (uint32_t seed: {uint32_t{0xFF}, uint32_t{0u}, uint32_t{0x9E3779B9u}, ~uint32_t{0}}){
+            for (size_t batch_sz: {size_t{0u}, size_t{1u}, size_t{3u}, size_t{5u}, size_t{7u}, size_t{9u}, size_t{13u}, size_t{31u}, bufs.size()}){
+                for (size_t first = 0u; first + batch_sz <= bufs.size(); first += std::max(batch_sz, size_t{1u}) * 3u + 1u){
+                    auto out        = std::vector<uint64_t>(batch_sz + 1u, 0xA5A5A5A5A5A5A5A5ull);
+                    auto expected   = std::vector<uint64_t>(batch_sz);
+
+                    dg::hasher::murmur_hash_many(bufs.data() + first, lens.data() + first, batch_sz, seed, out.data());
+                    dg::hasher::murmur_hash_many_scalar(bufs.data() + first, lens.data() + first, batch_sz, seed, expected.data());
+
+                    for (size_t i = 0u; i < batch_sz; ++i){
+                        EXPECT_EQ(out[i], expected[i]) << "isa = " << dg::cpu_dispatch::to_string(isa) << ", len = " << lens[first + i] << ", seed = " << seed;
+                        EXPECT_EQ(out[i], dg::hasher::murmur_hash(bufs[first + i], lens[first + i], seed)) << "isa = " << dg::cpu_dispatch::to_string(isa) << ", len = " << lens[first + i];
+                    }
+
+                    EXPECT_EQ(out[batch_sz], 0xA5A5A5A5A5A5A5A5ull) << "isa = " << dg::cpu_dispatch::to_string(isa) << ", wrote past n = " << batch_sz;
+                }
+            }
+        }
+    }
+
+    dg::cpu_dispatch::reset_isa();
+}
@@ -0,0 +1,1019 @@
+#include "ud_sym_encoder.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+//cmake -S . -B build && cmake --build build --target ud_sym_test && ctest --test-dir build
+
+namespace{
+
+    auto random_string(size_t sz, uint64_t seed = 0u) -> std::string{
+
+        auto randgen    = std::mt19937_64{seed};
+        std::string rs(sz, ' ');
+
+        for (char& c: rs){
+            c = static_cast<char>(randgen());
+        }
+
+        return rs;
+    }
+
+    auto secret() -> const std::string&{
+
+        static const std::string rs = "my_secret";
+        return rs;
+    }
+
+    auto uint_secret() -> uint64_t{
+
+        return dg::hasher::murmur_hash(secret().data(), secret().size());
+    }
+
+    //0 and the sizes around the 16 byte murmur blocks
+    auto payload_sizes() -> std::vector<size_t>{
+
+        return {0u, 1u, 15u, 16u, 17u, 255u, 256u, 4097u};
+    }
+
+    //every isa level the cpu runs - set_isa(isa) is valid for each
+    auto supported_isas() -> std::vector<dg::cpu_dispatch::Isa>{
+
+        auto rs = std::vector<dg::cpu_dispatch::Isa>{};
+
+        for (dg::cpu_dispatch::Isa isa: {dg::cpu_dispatch::Isa::scalar, dg::cpu_dispatch::Isa::sse4, dg::cpu_dispatch::Isa::avx2, dg::cpu_dispatch::Isa::avx512}){
+            if (isa <= dg::cpu_dispatch::detect_isa()){
+                rs.push_back(isa);
+            }
+        }
+
+        return rs;
+    }
+
+    using apply_fn = void (*)(const dg::ud_sym_encoder::byte_dict_type&, const char *, size_t, char *) noexcept;
+
+    //every ByteShuffleEngine kernel the cpu runs, called directly - apply() only ever reaches one of them
+    auto supported_shuffle_kernels() -> std::vector<std::pair<std::string, apply_fn>>{
+
+        auto rs = std::vector<std::pair<std::string, apply_fn>>{};
+
+#if DG_CPU_DISPATCH_X86
+        if (dg::cpu_dispatch::detect_isa() >= dg::cpu_dispatch::Isa::avx2){
+            rs.emplace_back("avx2", &dg::ud_sym_encoder::ByteShuffleEngine::apply_avx2);
+        }
+
+        if (dg::cpu_dispatch::detect_isa() >= dg::cpu_dispatch::Isa::avx512){
+            rs.emplace_back("avx512bw", &dg::ud_sym_encoder::ByteShuffleEngine::apply_avx512bw);
+        }
+
+        if (dg::cpu_dispatch::detect_isa() >= dg::cpu_dispatch::Isa::avx512 && dg::cpu_dispatch::has_avx512_vbmi()){
+            rs.emplace_back("avx512vbmi", &dg::ud_sym_encoder::ByteShuffleEngine::apply_avx512vbmi);
+        }
+#endif
+
+        return rs;
+    }
+
+    auto random_dict(uint64_t seed) -> dg::ud_sym_encoder::byte_dict_type{
+
+        auto rs = dg::ud_sym_encoder::byte_dict_type{};
+        std::iota(rs.begin(), rs.end(), uint8_t{0});
+        std::shuffle(rs.begin(), rs.end(), std::mt19937_64{seed});
+
+        return rs;
+    }
+
+    //the same salt on every encode - pins frames that spawn_* draws a random salt for
+    struct FixedSaltGenerator: dg::ud_sym_encoder::SaltGeneratorInterface{
+
+        uint64_t salt;
+
+        FixedSaltGenerator(uint64_t salt) noexcept: salt(salt){}
+
+        auto get() noexcept -> uint64_t{
+
+            return this->salt;
+        }
+    };
+
+    auto golden_plaintext() -> std::string{
+
+        return "the quick brown fox jumps over the lazy dog 0123456789";
+    }
+
+    auto from_hex(std::string_view hex) -> std::string{
+
+        auto rs = std::string(hex.size() / 2u, ' ');
+
+        for (size_t i = 0u; i < rs.size(); ++i){
+            rs[i] = static_cast<char>(std::stoi(std::string(hex.substr(i * 2u, 2u)), nullptr, 16));
+        }
+
+        return rs;
+    }
+
+    //{encoder, offset of the size field, offset of the payload} for the legacy and the keyed frame
+    auto murmur_frames() -> std::vector<std::tuple<dg::ud_sym_encoder::MurMurEncoder, size_t, size_t>>{
+
+        return {{dg::ud_sym_encoder::MurMurEncoder(uint_secret()), 8u, 16u},
+                {dg::ud_sym_encoder::MurMurEncoder(uint_secret(), dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT), 1u, 9u}};
+    }
+
+    constexpr size_t RECORD_SIZE = dg::ud_sym_encoder::StreamRecord::RECORD_SIZE;
+
+    auto stream_encode(dg::ud_sym_encoder::StreamingEncoder& encoder, const std::string& inp, size_t chunk_sz) -> std::string{
+
+        auto session    = encoder.encode_session();
+        std::string rs  = {};
+
+        for (size_t first = 0u; first < inp.size(); first += chunk_sz){
+            auto chunk  = std::span<const char>(inp).subspan(first, std::min(chunk_sz, inp.size() - first));
+            size_t sz   = rs.size();
+            rs.resize(sz + session.update_size(chunk.size()));
+            session.update(chunk, std::span<char>(rs).subspan(sz));
+        }
+
+        size_t sz = rs.size();
+        rs.resize(sz + session.finalize_size());
+        session.finalize(std::span<char>(rs).subspan(sz));
+
+        return rs;
+    }
+
+    //appends to out whatever the session hands out - left as is when a call throws
+    void stream_decode(dg::ud_sym_encoder::StreamingEncoder& encoder, const std::string& enc, size_t chunk_sz, std::string& out){
+
+        auto session = encoder.decode_session();
+
+        for (size_t first = 0u; first < enc.size(); first += chunk_sz){
+            auto chunk  = std::span<const char>(enc).subspan(first, std::min(chunk_sz, enc.size() - first));
+            auto buf    = std::string(session.update_size(chunk.size()), ' ');
+            buf.resize(session.update(chunk, std::span<char>(buf)));
+            out         += buf;
+        }
+
+        auto buf = std::string(session.finalize_size(), ' ');
+        buf.resize(session.finalize(std::span<char>(buf)));
+        out      += buf;
+    }
+
+    void expect_roundtrip(dg::ud_sym_encoder::EncoderInterface& encoder){
+
+        for (size_t sz: payload_sizes()){
+            std::string inp = random_string(sz, sz);
+            std::string enc = encoder.encode(inp);
+
+            EXPECT_EQ(enc.size(), encoder.encoded_size(sz)) << "sz = " << sz;
+            EXPECT_EQ(encoder.decode(enc), inp) << "sz = " << sz;
+        }
+    }
+}
+
+//wire bytes of the legacy encoders for a fixed secret, salt stream and plaintext - pinned from the pre-backlog tree, any change here breaks deployed readers
+TEST(GoldenBytes, Mt19937Encoder){
+
+    auto encoder = dg::ud_sym_encoder::Mt19937Encoder(secret(), dg::ud_sym_encoder::mt19937{1u});
+
+    EXPECT_EQ(encoder.encode(golden_plaintext()), from_hex("686f68bb5fbd45229e8b8f72719269637e3be0422ffb6f5dafcc572083e66dd7"
+                                                           "4fd0b7a3ad6d9a6de4114e0f69eb942017180a6f26314868801ccabc58c1"));
+}
+
+TEST(GoldenBytes, MurMurEncoder){
+
+    auto encoder = dg::ud_sym_encoder::MurMurEncoder(uint_secret());
+
+    EXPECT_EQ(encoder.encode(golden_plaintext()), from_hex("8984bb0b6b9dee8f360000000000000074686520717569636b2062726f776e20"
+                                                           "666f78206a756d7073206f76657220746865206c617a7920646f672030313233"
+                                                           "343536373839d9cc0215759103d1"));
+}
+
+TEST(GoldenBytes, DoubleEncoder){
+
+    auto encoder = dg::ud_sym_encoder::DoubleEncoder(std::make_unique<dg::ud_sym_encoder::MurMurEncoder>(uint_secret()),
+                                                     std::make_unique<dg::ud_sym_encoder::Mt19937Encoder>(secret(), dg::ud_sym_encoder::mt19937{1u}));
+
+    EXPECT_EQ(encoder.encode(golden_plaintext()), from_hex("686f68bb5fbd452221c0bbe76b06388f1c030061262ff367d2263f207be6695a"
+                                                           "a0d062dc21ff9c13fed10120773158cb6899f9d58c69ef9d87335cdf617ab84c"
+                                                           "026fa88713e5f9a961351c9e1b3748e9223558e407d1"));
+}
+
+//the pinned tokens still decode
+TEST(GoldenBytes, DecodesPinnedTokens){
+
+    auto mt19937_encoder    = dg::ud_sym_encoder::Mt19937Encoder(secret(), dg::ud_sym_encoder::mt19937{});
+    auto murmur_encoder     = dg::ud_sym_encoder::MurMurEncoder(uint_secret());
+
+    EXPECT_EQ(mt19937_encoder.decode(from_hex("686f68bb5fbd45229e8b8f72719269637e3be0422ffb6f5dafcc572083e66dd7"
+                                              "4fd0b7a3ad6d9a6de4114e0f69eb942017180a6f26314868801ccabc58c1")), golden_plaintext());
+    EXPECT_EQ(murmur_encoder.decode(from_hex("8984bb0b6b9dee8f360000000000000074686520717569636b2062726f776e20"
+                                             "666f78206a756d7073206f76657220746865206c617a7920646f672030313233"
+                                             "343536373839d9cc0215759103d1")), golden_plaintext());
+}
+
+TEST(SpawnEncoder, Roundtrip){
+
+    expect_roundtrip(*dg::ud_sym_encoder::spawn_encoder(secret()));
+}
+
+//the bytes the pre-FusedEncoder spawn_encoder (DoubleEncoder(MurMurEncoder, Mt19937Encoder(mt19937{}))) wrote for its first token - what every deployed reader decodes
+//spawn_encoder must emit exactly this frame for the salt it drew
+TEST(SpawnEncoder, EmitsLegacyFrame){
+
+    const std::string golden = from_hex("a6aef6f61c196dc98962bbc9146633c09769394c008ee10006d8bc6ddcebd163"
+                                        "6b76c7d28777f1a7a63f72658fd76d70f9c24b413f22877a211e3d6c6148fcbb"
+                                        "d2137e2002afa22980f76c9addd550b47b158eb503a7");
+
+    EXPECT_EQ(dg::ud_sym_encoder::FusedEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{}).encode(golden_plaintext()), golden);
+
+    auto encoder    = dg::ud_sym_encoder::spawn_encoder(secret());
+    std::string enc = encoder->encode(golden_plaintext());
+    uint64_t salt   = {};
+
+    ASSERT_EQ(enc.size(), golden.size());
+    dg::trivial_serializer::deserialize_into(salt, enc.data());
+
+    auto reference  = dg::ud_sym_encoder::DoubleEncoder(std::make_unique<dg::ud_sym_encoder::MurMurEncoder>(uint_secret()),
+                                                        std::make_unique<dg::ud_sym_encoder::Mt19937Encoder>(secret(), std::make_unique<FixedSaltGenerator>(salt)));
+
+    EXPECT_EQ(enc, reference.encode(golden_plaintext()));
+    EXPECT_EQ(encoder->decode(golden), golden_plaintext());
+}
+
+TEST(SpawnKeyedEncoder, RoundtripDecodesLegacy){
+
+    auto encoder = dg::ud_sym_encoder::spawn_keyed_encoder(secret());
+
+    expect_roundtrip(*encoder);
+    EXPECT_EQ(encoder->decode(dg::ud_sym_encoder::spawn_encoder(secret())->encode(golden_plaintext())), golden_plaintext());
+    EXPECT_EQ(dg::ud_sym_encoder::spawn_encoder(secret())->decode(encoder->encode(golden_plaintext())), golden_plaintext());
+}
+
+TEST(SpawnEncoder, RejectsTamperedFrame){
+
+    auto encoder    = dg::ud_sym_encoder::spawn_encoder(secret());
+    std::string enc = encoder->encode(random_string(64u));
+
+    for (size_t i = 0u; i < enc.size(); ++i){
+        std::string bad = enc;
+        bad[i]          ^= 0x01;
+        EXPECT_THROW(encoder->decode(bad), dg::ud_sym_encoder::bad_encoding_format) << "byte " << i;
+    }
+}
+
+TEST(SpawnEncoder, RejectsOtherSecret){
+
+    std::string enc = dg::ud_sym_encoder::spawn_encoder(secret())->encode(random_string(64u));
+    EXPECT_THROW(dg::ud_sym_encoder::spawn_encoder("other_secret")->decode(enc), dg::ud_sym_encoder::bad_encoding_format);
+}
+
+//one encoder shared by every thread - each thread decodes its own tokens and the tokens of the thread before it, no two tokens share a salt
+TEST(SpawnEncoder, SharedAcrossThreads){
+
+    constexpr size_t THREAD_COUNT   = 8u;
+    constexpr size_t ITERATIONS     = 64u;
+
+    auto encoder    = dg::ud_sym_encoder::spawn_encoder(secret());
+    auto tokens     = std::vector<std::vector<std::string>>(THREAD_COUNT, std::vector<std::string>(ITERATIONS));
+    auto inps       = std::vector<std::vector<std::string>>(THREAD_COUNT, std::vector<std::string>(ITERATIONS));
+    auto failures   = std::atomic<size_t>{0u};
+
+    {
+        auto workers = std::vector<std::jthread>{};
+
+        for (size_t thread_idx = 0u; thread_idx < THREAD_COUNT; ++thread_idx){
+            workers.emplace_back([&, thread_idx]{
+                for (size_t i = 0u; i < ITERATIONS; ++i){
+                    inps[thread_idx][i]     = random_string(i * 7u, static_cast<uint32_t>(thread_idx * ITERATIONS + i));
+                    tokens[thread_idx][i]   = encoder->encode(inps[thread_idx][i]);
+
+                    if (encoder->decode(tokens[thread_idx][i]) != inps[thread_idx][i]){
+                        failures.fetch_add(1u, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+    }
+
+    EXPECT_EQ(failures.load(), 0u);
+
+    auto salts = std::vector<uint64_t>{};
+
+    for (size_t thread_idx = 0u; thread_idx < THREAD_COUNT; ++thread_idx){
+        for (size_t i = 0u; i < ITERATIONS; ++i){
+            uint64_t salt = {};
+            dg::trivial_serializer::deserialize_into(salt, tokens[thread_idx][i].data());
+            salts.push_back(salt);
+        }
+    }
+
+    std::sort(salts.begin(), salts.end());
+    EXPECT_EQ(std::adjacent_find(salts.begin(), salts.end()), salts.end());
+
+    {
+        auto workers = std::vector<std::jthread>{};
+
+        for (size_t thread_idx = 0u; thread_idx < THREAD_COUNT; ++thread_idx){
+            workers.emplace_back([&, thread_idx]{
+                size_t other_idx = (thread_idx + 1u) % THREAD_COUNT;
+
+                for (size_t i = 0u; i < ITERATIONS; ++i){
+                    if (encoder->decode(tokens[other_idx][i]) != inps[other_idx][i]){
+                        failures.fetch_add(1u, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+    }
+
+    EXPECT_EQ(failures.load(), 0u);
+}
+
+TEST(FusedEncoder, MatchesDoubleEncoderBytes){
+
+    auto fused  = dg::ud_sym_encoder::FusedEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{1u});
+    auto stack  = dg::ud_sym_encoder::DoubleEncoder(std::make_unique<dg::ud_sym_encoder::MurMurEncoder>(uint_secret()),
+                                                    std::make_unique<dg::ud_sym_encoder::Mt19937Encoder>(secret(), dg::ud_sym_encoder::mt19937{1u}));
+
+    for (size_t sz: payload_sizes()){
+        std::string inp = random_string(sz, sz);
+        EXPECT_EQ(fused.encode(inp), stack.encode(inp)) << "sz = " << sz;
+    }
+}
+
+TEST(FusedEncoder, KeyedMatchesDoubleEncoderBytes){
+
+    auto fused  = dg::ud_sym_encoder::FusedEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{1u}, dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+    auto stack  = dg::ud_sym_encoder::DoubleEncoder(std::make_unique<dg::ud_sym_encoder::MurMurEncoder>(uint_secret(), dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT),
+                                                    std::make_unique<dg::ud_sym_encoder::Mt19937Encoder>(secret(), dg::ud_sym_encoder::mt19937{1u}));
+
+    for (size_t sz: payload_sizes()){
+        std::string inp = random_string(sz, sz);
+        EXPECT_EQ(fused.encode(inp), stack.encode(inp)) << "sz = " << sz;
+    }
+}
+
+//either format decodes the frames of the other
+TEST(FusedEncoder, DecodesLegacyAndKeyedFrames){
+
+    auto legacy = dg::ud_sym_encoder::FusedEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{1u});
+    auto keyed  = dg::ud_sym_encoder::FusedEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{2u}, dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+
+    for (size_t sz: payload_sizes()){
+        std::string inp = random_string(sz, sz);
+
+        EXPECT_EQ(keyed.decode(legacy.encode(inp)), inp) << "sz = " << sz;
+        EXPECT_EQ(legacy.decode(keyed.encode(inp)), inp) << "sz = " << sz;
+        EXPECT_EQ(keyed.encode(inp).size() + 7u, legacy.encode(inp).size());
+    }
+}
+
+TEST(MurMurEncoder, KeyedRoundtripDecodesLegacy){
+
+    auto legacy = dg::ud_sym_encoder::MurMurEncoder(uint_secret());
+    auto keyed  = dg::ud_sym_encoder::MurMurEncoder(uint_secret(), dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+
+    expect_roundtrip(keyed);
+
+    for (size_t sz: payload_sizes()){
+        std::string inp = random_string(sz, sz);
+        std::string enc = keyed.encode(inp);
+
+        EXPECT_EQ(static_cast<uint8_t>(enc[0]), dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+        EXPECT_EQ(keyed.decode(legacy.encode(inp)), inp) << "sz = " << sz;
+    }
+}
+
+TEST(MurMurEncoder, KeyedRejectsTamperedFrame){
+
+    auto encoder    = dg::ud_sym_encoder::MurMurEncoder(uint_secret(), dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+    std::string enc = encoder.encode(random_string(40u));
+
+    for (size_t i = 0u; i < enc.size(); ++i){
+        std::string bad = enc;
+        bad[i]          ^= 0x01;
+        EXPECT_THROW(encoder.decode(bad), dg::ud_sym_encoder::bad_encoding_format) << "byte " << i;
+    }
+}
+
+//the keyed hash is seeded with all 64 bits of the secret - secrets equal in their low half do not share frames
+TEST(MurMurEncoder, KeyedUsesFullSecret){
+
+    uint64_t low    = 0x0123456789ABCDEFull;
+    uint64_t high   = low ^ (uint64_t{1} << 63);
+    auto encoder    = dg::ud_sym_encoder::MurMurEncoder(low, dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+    auto other      = dg::ud_sym_encoder::MurMurEncoder(high, dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT);
+    std::string inp = random_string(100u);
+
+    EXPECT_NE(encoder.encode(inp), other.encode(inp));
+    EXPECT_THROW(other.decode(encoder.encode(inp)), dg::ud_sym_encoder::bad_encoding_format);
+}
+
+TEST(MurMurEncoder, DecodeViewAliasesInput){
+
+    for (auto& [encoder, size_offset, payload_offset]: murmur_frames()){
+        for (size_t sz: payload_sizes()){
+            std::string inp     = random_string(sz, sz);
+            std::string enc     = encoder.encode(inp);
+            std::string_view rs = encoder.decode_view(std::span<const char>(enc));
+
+            EXPECT_EQ(rs, inp) << "sz = " << sz;
+            EXPECT_EQ(rs.data(), enc.data() + payload_offset) << "sz = " << sz;
+        }
+    }
+}
+
+TEST(MurMurEncoder, DecodeViewRejectsTamperedFrame){
+
+    for (auto& [encoder, size_offset, payload_offset]: murmur_frames()){
+        std::string enc = encoder.encode(random_string(40u));
+
+        for (size_t i = 0u; i < enc.size(); ++i){
+            std::string bad = enc;
+            bad[i]          ^= 0x01;
+            EXPECT_THROW(encoder.decode_view(std::span<const char>(bad)), dg::ud_sym_encoder::bad_encoding_format) << "payload_offset = " << payload_offset << ", byte " << i;
+        }
+    }
+}
+
+//a size field off by one either way or past the buffer, and a frame missing its last byte
+TEST(MurMurEncoder, DecodeViewRejectsTruncatedLength){
+
+    for (auto& [encoder, size_offset, payload_offset]: murmur_frames()){
+        std::string enc = encoder.encode(random_string(40u));
+
+        for (uint64_t sz: {uint64_t{39u}, uint64_t{41u}, uint64_t{0u}, std::numeric_limits<uint64_t>::max()}){
+            std::string bad = enc;
+            dg::compact_serializer::serialize_into(bad.data() + size_offset, sz);
+            EXPECT_THROW(encoder.decode_view(std::span<const char>(bad)), dg::ud_sym_encoder::bad_encoding_format) << "payload_offset = " << payload_offset << ", sz = " << sz;
+        }
+
+        for (size_t sz: {size_t{0u}, payload_offset, enc.size() - 1u}){
+            EXPECT_THROW(encoder.decode_view(std::span<const char>(enc.data(), sz)), dg::ud_sym_encoder::bad_encoding_format) << "payload_offset = " << payload_offset << ", sz = " << sz;
+        }
+    }
+}
+
+TEST(SpawnStreamingEncoder, ChunkedRoundtrip){
+
+    auto encoder = dg::ud_sym_encoder::spawn_streaming_encoder(secret());
+
+    const auto cases = std::vector<std::pair<size_t, size_t>>{{0u, 29u}, {1000u, 29u}, {RECORD_SIZE - 1u, RECORD_SIZE + 7u}, {RECORD_SIZE, 4097u},
+                                                              {RECORD_SIZE + 1u, 29u}, {2u * RECORD_SIZE + 123u, RECORD_SIZE + 7u}};
+
+    for (auto [sz, chunk_sz]: cases){
+        std::string inp = random_string(sz, sz);
+        std::string enc = stream_encode(*encoder, inp, chunk_sz);
+        std::string dec{};
+
+        EXPECT_EQ(enc.size(), sizeof(uint64_t) + sz + (sz / RECORD_SIZE + 1u) * sizeof(uint64_t)) << "sz = " << sz;
+        EXPECT_NO_THROW(stream_decode(*encoder, enc, chunk_sz + 3u, dec)) << "sz = " << sz << ", chunk_sz = " << chunk_sz;
+        EXPECT_EQ(dec, inp) << "sz = " << sz << ", chunk_sz = " << chunk_sz;
+    }
+}
+
+//a flipped byte in any record, the salt or a tag - nothing of the failing record or after it reaches the caller
+TEST(SpawnStreamingEncoder, DecodeRejectsFlippedByte){
+
+    auto encoder    = dg::ud_sym_encoder::spawn_streaming_encoder(secret());
+    std::string inp = random_string(RECORD_SIZE + 123u);
+    std::string enc = stream_encode(*encoder, inp, 4097u);
+
+    const size_t record_frame_sz = RECORD_SIZE + sizeof(uint64_t);
+
+    for (size_t i: {size_t{0u}, size_t{7u}, size_t{8u}, size_t{9u}, 8u + RECORD_SIZE - 1u, 8u + RECORD_SIZE, 8u + record_frame_sz - 1u,
+                    8u + record_frame_sz, enc.size() - 9u, enc.size() - 1u}){
+        std::string bad     = enc;
+        std::string dec     = {};
+        bad[i]              ^= 0x01;
+        size_t authentic_sz = i < 8u ? 0u : std::min((i - 8u) / record_frame_sz, size_t{1u}) * RECORD_SIZE;
+
+        EXPECT_THROW(stream_decode(*encoder, bad, 1000u, dec), dg::ud_sym_encoder::bad_encoding_format) << "byte " << i;
+        EXPECT_EQ(dec, inp.substr(0u, authentic_sz)) << "byte " << i;
+    }
+}
+
+TEST(SpawnStreamingEncoder, DecodeRejectsTruncatedStream){
+
+    auto encoder    = dg::ud_sym_encoder::spawn_streaming_encoder(secret());
+    std::string inp = random_string(RECORD_SIZE + 123u);
+    std::string enc = stream_encode(*encoder, inp, 4097u);
+
+    for (size_t sz: {size_t{0u}, size_t{7u}, size_t{8u}, size_t{16u}, 8u + RECORD_SIZE, 8u + RECORD_SIZE + 8u, enc.size() - 8u, enc.size() - 1u}){
+        std::string dec = {};
+
+        EXPECT_THROW(stream_decode(*encoder, enc.substr(0u, sz), 1000u, dec), dg::ud_sym_encoder::bad_encoding_format) << "sz = " << sz;
+        EXPECT_EQ(dec, inp.substr(0u, sz >= 8u + RECORD_SIZE + 8u ? RECORD_SIZE : 0u)) << "sz = " << sz;
+    }
+}
+
+//bytes past the last tag - shorter than a record, or long enough to complete one
+TEST(SpawnStreamingEncoder, DecodeRejectsTrailingGarbage){
+
+    auto encoder = dg::ud_sym_encoder::spawn_streaming_encoder(secret());
+
+    for (size_t sz: {size_t{100u}, RECORD_SIZE}){
+        std::string inp = random_string(sz, sz);
+        std::string enc = stream_encode(*encoder, inp, 4097u);
+
+        for (size_t garbage_sz: {size_t{1u}, size_t{9u}, RECORD_SIZE + 8u}){
+            std::string dec = {};
+
+            EXPECT_THROW(stream_decode(*encoder, enc + random_string(garbage_sz, 1u), 1000u, dec), dg::ud_sym_encoder::bad_encoding_format) << "sz = " << sz << ", garbage_sz = " << garbage_sz;
+            EXPECT_EQ(dec, inp.substr(0u, (sz / RECORD_SIZE) * RECORD_SIZE)) << "sz = " << sz << ", garbage_sz = " << garbage_sz;
+        }
+    }
+}
+
+TEST(SpawnStreamingEncoder, DecodeRejectsOtherSecret){
+
+    std::string enc = stream_encode(*dg::ud_sym_encoder::spawn_streaming_encoder(secret()), random_string(100u), 29u);
+    std::string dec = {};
+
+    EXPECT_THROW(stream_decode(*dg::ud_sym_encoder::spawn_streaming_encoder("other_secret"), enc, 29u, dec), dg::ud_sym_encoder::bad_encoding_format);
+    EXPECT_TRUE(dec.empty());
+}
+
+TEST(EncodeBatch, MatchesSingleCalls){
+
+    auto encoder    = dg::ud_sym_encoder::spawn_encoder(secret());
+    auto inps       = std::vector<std::string>{};
+    auto views      = std::vector<std::string_view>{};
+    auto enc_arena  = dg::ud_sym_encoder::OutputArena{};
+    auto dec_arena  = dg::ud_sym_encoder::OutputArena{};
+
+    for (size_t sz: payload_sizes()){
+        inps.push_back(random_string(sz, sz));
+    }
+
+    views.assign(inps.begin(), inps.end());
+    encoder->encode_batch(views, enc_arena);
+    ASSERT_EQ(enc_arena.size(), inps.size());
+
+    views.clear();
+
+    for (size_t i = 0u; i < enc_arena.size(); ++i){
+        views.push_back(enc_arena[i]);
+    }
+
+    encoder->decode_batch(views, dec_arena);
+    ASSERT_EQ(dec_arena.size(), inps.size());
+
+    for (size_t i = 0u; i < inps.size(); ++i){
+        EXPECT_EQ(dec_arena[i], inps[i]);
+        EXPECT_EQ(encoder->decode(std::string(enc_arena[i])), inps[i]);
+    }
+}
+
+//a bad item anywhere in the batch - the arena comes back empty, both for the FusedEncoder override and the EncoderInterface default
+TEST(DecodeBatch, ThrowLeavesArenaEmpty){
+
+    auto fused      = dg::ud_sym_encoder::spawn_encoder(secret());
+    auto block      = dg::ud_sym_encoder::spawn_block_encoder(secret());
+
+    for (dg::ud_sym_encoder::EncoderInterface * encoder: {fused.get(), block.get()}){
+        std::string first   = encoder->encode(random_string(100u));
+        std::string second  = encoder->encode(random_string(100u, 1u));
+        second.back()       ^= 0x01;
+        auto views          = std::vector<std::string_view>{first, second};
+        auto arena          = dg::ud_sym_encoder::OutputArena{};
+
+        EXPECT_THROW(encoder->decode_batch(views, arena), dg::ud_sym_encoder::bad_encoding_format);
+        EXPECT_EQ(arena.size(), 0u);
+        EXPECT_TRUE(arena.buf.empty());
+    }
+}
+
+//philox4x32_10 known answers from Random123 (kat_vectors)
+TEST(Philox4x32, KnownAnswerVectors){
+
+    using philox = dg::ud_sym_encoder::Philox4x32;
+
+    EXPECT_EQ(philox::block({0x00000000u, 0x00000000u}, {0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u}),
+              (philox::counter_type{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}));
+    EXPECT_EQ(philox::block({0xffffffffu, 0xffffffffu}, {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}),
+              (philox::counter_type{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}));
+    EXPECT_EQ(philox::block({0xa4093822u, 0x299f31d0u}, {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}),
+              (philox::counter_type{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}));
+}
+
+//every SIMD fill against block() - block counts off the lane width, and a counter range that carries into the high word
+TEST(Philox4x32, FillMatchesBlockOnEveryIsa){
+
+    using philox = dg::ud_sym_encoder::Philox4x32;
+
+    const auto key = philox::key_type{0xa4093822u, 0x299f31d0u};
+
+    for (dg::cpu_dispatch::Isa isa: supported_isas()){
+        dg::cpu_dispatch::set_isa(isa);
+
+        for (uint64_t ctr: {uint64_t{0}, uint64_t{0xFFFFFFF0u}, ~uint64_t{0} - 40u}){
+            for (size_t nblocks: {0u, 1u, 3u, 4u, 7u, 8u, 15u, 16u, 17u, 37u}){
+                auto out = std::vector<uint8_t>(nblocks * 16u);
+                philox::fill(key, ctr, nblocks, out.data());
+
+                for (size_t i = 0u; i < nblocks; ++i){
+                    uint64_t block_ctr  = ctr + i;
+                    auto expected       = philox::block(key, {static_cast<uint32_t>(block_ctr), static_cast<uint32_t>(block_ctr >> 32), 0u, 0u});
+
+                    for (size_t j = 0u; j < expected.size(); ++j){
+                        EXPECT_EQ(dg::compact_serializer::utility::SyncedEndiannessService::load<uint32_t>(reinterpret_cast<const char *>(out.data() + i * 16u + j * 4u)), expected[j])
+                            << "isa = " << dg::cpu_dispatch::to_string(isa) << ", ctr = " << ctr << ", block " << i;
+                    }
+                }
+            }
+        }
+    }
+
+    dg::cpu_dispatch::reset_isa();
+}
+
+TEST(PhiloxStream, SeekMatchesSequentialDraws){
+
+    auto sequential = dg::ud_sym_encoder::PhiloxStream{0x0123456789ABCDEFull};
+    auto draws      = std::vector<uint8_t>(4096u);
+
+    for (uint8_t& draw: draws){
+        draw = sequential();
+    }
+
+    for (size_t draw_idx: {0u, 1u, 15u, 16u, 511u, 512u, 513u, 1000u, 4000u}){
+        auto seeked = dg::ud_sym_encoder::PhiloxStream{0x0123456789ABCDEFull};
+        seeked.seek(draw_idx);
+
+        for (size_t i = draw_idx; i < draws.size(); ++i){
+            ASSERT_EQ(seeked(), draws[i]) << "seek " << draw_idx << ", draw " << i;
+        }
+    }
+}
+
+TEST(PhiloxEncoder, Roundtrip){
+
+    auto encoder = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+    expect_roundtrip(encoder);
+}
+
+TEST(PhiloxEncoder, RejectsTamperedFrame){
+
+    auto encoder    = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+    std::string enc = encoder.encode(random_string(64u));
+
+    for (size_t i = 0u; i < enc.size(); ++i){
+        std::string bad = enc;
+        bad[i]          ^= 0x01;
+        EXPECT_THROW(encoder.decode(bad), dg::ud_sym_encoder::bad_encoding_format) << "byte " << i;
+    }
+}
+
+//either encode tag is read back by a versioned encoder writing the other one
+TEST(VersionedEncoder, DecodesEveryTag){
+
+    auto mt19937_encoder    = dg::ud_sym_encoder::spawn_versioned_encoder(secret(), dg::ud_sym_encoder::constants::MT19937_FORMAT);
+    auto philox_encoder     = dg::ud_sym_encoder::spawn_versioned_encoder(secret(), dg::ud_sym_encoder::constants::PHILOX_FORMAT);
+
+    expect_roundtrip(*mt19937_encoder);
+    expect_roundtrip(*philox_encoder);
+
+    for (size_t sz: payload_sizes()){
+        std::string inp         = random_string(sz, sz);
+        std::string mt19937_enc = mt19937_encoder->encode(inp);
+        std::string philox_enc  = philox_encoder->encode(inp);
+
+        ASSERT_EQ(static_cast<uint8_t>(mt19937_enc[0]), dg::ud_sym_encoder::constants::MT19937_FORMAT);
+        ASSERT_EQ(static_cast<uint8_t>(philox_enc[0]), dg::ud_sym_encoder::constants::PHILOX_FORMAT);
+        EXPECT_EQ(philox_encoder->decode(mt19937_enc), inp) << "sz = " << sz;
+        EXPECT_EQ(mt19937_encoder->decode(philox_enc), inp) << "sz = " << sz;
+    }
+}
+
+TEST(VersionedEncoder, RejectsUnknownOrTruncatedTag){
+
+    auto encoder    = dg::ud_sym_encoder::spawn_versioned_encoder(secret());
+    std::string enc = encoder->encode(random_string(64u));
+
+    for (uint8_t tag: {dg::ud_sym_encoder::constants::MURMUR_LEGACY_FORMAT, dg::ud_sym_encoder::constants::MURMUR_KEYED_FORMAT, uint8_t{0x04}, uint8_t{0xFF}}){
+        std::string bad = enc;
+        bad[0]          = static_cast<char>(tag);
+        EXPECT_THROW(encoder->decode(bad), dg::ud_sym_encoder::bad_encoding_format) << "tag = " << static_cast<int>(tag);
+    }
+
+    EXPECT_THROW(encoder->decode(std::string{}), dg::ud_sym_encoder::bad_encoding_format);
+    EXPECT_THROW(encoder->decode(enc.substr(0u, 1u)), dg::ud_sym_encoder::bad_encoding_format);
+    EXPECT_THROW(encoder->decode(enc.substr(0u, enc.size() - 1u)), dg::ud_sym_encoder::bad_encoding_format);
+}
+
+TEST(VersionedEncoder, RejectsTamperedFrame){
+
+    for (uint8_t tag: {dg::ud_sym_encoder::constants::MT19937_FORMAT, dg::ud_sym_encoder::constants::PHILOX_FORMAT}){
+        auto encoder    = dg::ud_sym_encoder::spawn_versioned_encoder(secret(), tag);
+        std::string enc = encoder->encode(random_string(64u));
+
+        for (size_t i = 0u; i < enc.size(); ++i){
+            std::string bad = enc;
+            bad[i]          ^= 0x01;
+            EXPECT_THROW(encoder->decode(bad), dg::ud_sym_encoder::bad_encoding_format) << "tag = " << static_cast<int>(tag) << ", byte " << i;
+        }
+    }
+}
+
+//every boundary of the payload - first byte, last byte, empty ranges at 0 and at the end, ranges crossing the dict block every byte advances
+TEST(PhiloxEncoder, DecodeRangeMatchesDecodeSubstr){
+
+    auto encoder    = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+    std::string inp = random_string(4097u);
+    std::string enc = encoder.encode(inp);
+
+    ASSERT_EQ(encoder.decode(enc), inp);
+
+    for (size_t offset: {0u, 1u, 15u, 16u, 17u, 1000u, 4095u, 4096u, 4097u}){
+        for (size_t len: {size_t{0u}, size_t{1u}, size_t{17u}, size_t{256u}, inp.size() - offset}){
+            if (offset + len > inp.size()){
+                continue;
+            }
+
+            EXPECT_EQ(encoder.decode_range(enc, offset, len), inp.substr(offset, len)) << "offset = " << offset << ", len = " << len;
+        }
+    }
+}
+
+TEST(PhiloxEncoder, DecodeRangeRejectsOutOfRange){
+
+    auto encoder    = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+    std::string inp = random_string(64u);
+    std::string enc = encoder.encode(inp);
+
+    EXPECT_THROW(encoder.decode_range(enc, 65u, 0u), dg::ud_sym_encoder::invalid_argument);
+    EXPECT_THROW(encoder.decode_range(enc, 64u, 1u), dg::ud_sym_encoder::invalid_argument);
+    EXPECT_THROW(encoder.decode_range(enc, 0u, 65u), dg::ud_sym_encoder::invalid_argument);
+
+    auto out = std::array<char, 8>{};
+    EXPECT_THROW(encoder.decode_range(std::span<const char>(enc), 60u, std::span<char>(out)), dg::ud_sym_encoder::invalid_argument);
+    EXPECT_THROW(encoder.decode_range(enc.substr(0u, enc.size() - 1u), 0u, 1u), dg::ud_sym_encoder::bad_encoding_format);
+}
+
+//payload sizes below one segment, at the segment boundaries and off them - every thread count gives the decode bytes
+TEST(PhiloxEncoder, DecodeParallelMatchesDecode){
+
+    auto encoder = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+
+    for (size_t sz: {0u, 1u, 4095u, 4096u, 8192u, 5u * 4096u + 123u}){
+        std::string inp = random_string(sz, sz);
+        std::string enc = encoder.encode(inp);
+
+        for (size_t thread_count = 0u; thread_count <= 8u; ++thread_count){
+            auto out = std::string(encoder.max_decoded_size(enc.size()), ' ');
+            out.resize(encoder.decode_parallel(std::span<const char>(enc), std::span<char>(out), thread_count));
+
+            EXPECT_EQ(out, inp) << "sz = " << sz << ", thread_count = " << thread_count;
+        }
+    }
+}
+
+//flips in the header, inside every segment and in the trailer
+TEST(PhiloxEncoder, DecodeParallelRejectsTamperedFrame){
+
+    auto encoder    = dg::ud_sym_encoder::PhiloxEncoder(uint_secret(), secret(), dg::ud_sym_encoder::mt19937{});
+    std::string enc = encoder.encode(random_string(5u * 4096u + 123u));
+
+    for (size_t thread_count: {1u, 2u, 5u, 8u}){
+        for (size_t i = 0u; i < enc.size(); i += (i < 32u || i + 32u > enc.size()) ? 1u : 2039u){
+            std::string bad = enc;
+            auto out        = std::string(encoder.max_decoded_size(bad.size()), ' ');
+            bad[i]          ^= 0x01;
+
+            EXPECT_THROW(encoder.decode_parallel(std::span<const char>(bad), std::span<char>(out), thread_count), dg::ud_sym_encoder::bad_encoding_format)
+                << "byte " << i << ", thread_count = " << thread_count;
+        }
+    }
+}
+
+//every length around the 32 / 64 byte vectors and their tails - out of place, in place, and out one byte before inp
+TEST(ByteShuffleEngine, KernelsMatchScalar){
+
+    auto dict = random_dict(7u);
+
+    for (const auto& [name, kernel]: supported_shuffle_kernels()){
+        for (size_t sz = 0u; sz <= 300u; ++sz){
+            std::string inp         = random_string(sz, sz);
+            std::string expected    = std::string(sz, ' ');
+            std::string out         = std::string(sz, ' ');
+            std::string in_place    = inp;
+            std::string shifted     = ' ' + inp;
+
+            dg::ud_sym_encoder::ByteShuffleEngine::apply_scalar(dict, inp.data(), sz, expected.data());
+            kernel(dict, inp.data(), sz, out.data());
+            kernel(dict, in_place.data(), sz, in_place.data());
+            kernel(dict, shifted.data() + 1, sz, shifted.data());
+
+            ASSERT_EQ(out, expected) << name << ", sz = " << sz;
+            ASSERT_EQ(in_place, expected) << name << " in place, sz = " << sz;
+            ASSERT_EQ(shifted.substr(0u, sz), expected) << name << " out before inp, sz = " << sz;
+        }
+    }
+}
+
+//every byte value through every table entry - the high-nibble selects of the avx2 / avx512bw kernels
+TEST(ByteShuffleEngine, KernelsCoverEveryByteValue){
+
+    auto inp = std::string(256u, ' ');
+
+    for (size_t i = 0u; i < inp.size(); ++i){
+        inp[i] = static_cast<char>(i);
+    }
+
+    for (uint64_t seed = 0u; seed < 8u; ++seed){
+        auto dict               = random_dict(seed);
+        std::string expected    = std::string(inp.size(), ' ');
+        dg::ud_sym_encoder::ByteShuffleEngine::apply_scalar(dict, inp.data(), inp.size(), expected.data());
+
+        for (const auto& [name, kernel]: supported_shuffle_kernels()){
+            std::string out = std::string(inp.size(), ' ');
+            kernel(dict, inp.data(), inp.size(), out.data());
+            EXPECT_EQ(out, expected) << name << ", seed = " << seed;
+        }
+    }
+}
+
+//block_size = 1 draws one dict per byte - the Mt19937Encoder stream
+TEST(BlockPermutationEncoder, BlockSizeOneMatchesMt19937Encoder){
+
+    for (uint64_t salt_seed: {1u, 2u, 3u}){
+        auto block  = dg::ud_sym_encoder::BlockPermutationEncoder(secret(), dg::ud_sym_encoder::mt19937{salt_seed}, 1u);
+        auto mt     = dg::ud_sym_encoder::Mt19937Encoder(secret(), dg::ud_sym_encoder::mt19937{salt_seed});
+
+        for (size_t sz: payload_sizes()){
+            std::string inp = random_string(sz, sz);
+            EXPECT_EQ(block.encode(inp), mt.encode(inp)) << "salt seed " << salt_seed << ", sz = " << sz;
+        }
+    }
+}
+
+namespace{
+
+    //0, one byte, segment edges, and several segments with a short tail
+    auto segmented_sizes() -> std::vector<size_t>{
+
+        constexpr size_t SEGMENT_SZ = dg::ud_sym_encoder::SegmentedEncoder::MIN_SEGMENT_SIZE;
+        return {0u, 1u, SEGMENT_SZ - 1u, SEGMENT_SZ, SEGMENT_SZ + 1u, SEGMENT_SZ * 3u + 17u, SEGMENT_SZ * 10u};
+    }
+
+    //block_size = 1 is the default per-byte mode, anything else goes through the WeakBlockConstantDicts opt-in
+    auto make_segmented(size_t thread_count, uint64_t salt_seed = 1u, size_t block_size = 1u) -> dg::ud_sym_encoder::SegmentedEncoder{
+
+        if (block_size == 1u){
+            return dg::ud_sym_encoder::SegmentedEncoder(secret(), dg::ud_sym_encoder::mt19937{salt_seed}, thread_count, dg::ud_sym_encoder::SegmentedEncoder::MIN_SEGMENT_SIZE);
+        }
+
+        return dg::ud_sym_encoder::SegmentedEncoder(secret(), dg::ud_sym_encoder::mt19937{salt_seed}, dg::ud_sym_encoder::WeakBlockConstantDicts{block_size}, thread_count, dg::ud_sym_encoder::SegmentedEncoder::MIN_SEGMENT_SIZE);
+    }
+}
+
+//thread_count is local - the frame does not depend on it
+TEST(SegmentedEncoder, RoundtripAcrossThreadCounts){
+
+    for (size_t block_size: {size_t{1}, size_t{1000}, dg::ud_sym_encoder::BlockPermutationEncoder::DEFAULT_BLOCK_SIZE}){
+        for (size_t thread_count: {1u, 3u, 8u}){
+            auto encoder    = make_segmented(thread_count, 1u, block_size);
+            auto reference  = make_segmented(1u, 1u, block_size);
+
+            for (size_t sz: segmented_sizes()){
+                std::string inp = random_string(sz, sz);
+                std::string enc = encoder.encode(inp);
+
+                EXPECT_EQ(enc.size(), encoder.encoded_size(sz));
+                EXPECT_EQ(enc, reference.encode(inp)) << "threads = " << thread_count << ", block = " << block_size << ", sz = " << sz;
+                EXPECT_EQ(encoder.decode(enc), inp) << "threads = " << thread_count << ", block = " << block_size << ", sz = " << sz;
+            }
+        }
+    }
+}
+
+//in at the payload offset of out - the layout DoubleEncoder hands its second encoder
+TEST(SegmentedEncoder, EncodesInPlaceAtPayloadOffset){
+
+    for (size_t sz: segmented_sizes()){
+        auto encoder        = make_segmented(3u);
+        auto reference      = make_segmented(3u);
+        std::string inp     = random_string(sz, sz);
+        std::string buf     = std::string(encoder.encoded_size(sz), ' ');
+        size_t offset       = buf.size() - sz;
+
+        std::copy(inp.begin(), inp.end(), buf.begin() + offset);
+        EXPECT_EQ(encoder.encode(std::span<const char>(buf.data() + offset, sz), std::span<char>(buf)), buf.size());
+        EXPECT_EQ(buf, reference.encode(inp)) << "sz = " << sz;
+    }
+}
+
+TEST(SegmentedEncoder, DecodesInPlace){
+
+    auto encoder = make_segmented(3u);
+
+    for (size_t sz: segmented_sizes()){
+        std::string inp = random_string(sz, sz);
+        std::string buf = encoder.encode(inp);
+
+        EXPECT_EQ(encoder.decode(std::span<const char>(buf), std::span<char>(buf)), sz);
+        EXPECT_EQ(buf.substr(0u, sz), inp) << "sz = " << sz;
+    }
+}
+
+//input under the header, the table, or the front of the payload - each used to produce a frame that failed its own decode
+TEST(SegmentedEncoder, RejectsOverlappingEncode){
+
+    constexpr size_t SZ = dg::ud_sym_encoder::SegmentedEncoder::MIN_SEGMENT_SIZE * 3u;
+
+    auto encoder    = make_segmented(3u);
+    std::string buf = std::string(encoder.encoded_size(SZ) + SZ, ' ');
+    size_t offset   = encoder.encoded_size(SZ) - SZ;
+
+    for (size_t first: {size_t{0}, size_t{8}, size_t{24}, offset - 1u, offset + 1u}){
+        EXPECT_THROW(encoder.encode(std::span<const char>(buf.data() + first, SZ), std::span<char>(buf.data(), encoder.encoded_size(SZ))), dg::ud_sym_encoder::invalid_argument) << "input at " << first;
+    }
+}
+
+//out past the payload - the apply would overwrite input it has not read yet
+TEST(SegmentedEncoder, RejectsOverlappingDecodePastPayload){
+
+    constexpr size_t SZ = dg::ud_sym_encoder::SegmentedEncoder::MIN_SEGMENT_SIZE * 3u;
+
+    auto encoder    = make_segmented(3u);
+    std::string enc = encoder.encode(random_string(SZ));
+    std::string buf = enc + std::string(SZ, ' ');
+    size_t offset   = enc.size() - SZ;
+
+    EXPECT_THROW(encoder.decode(std::span<const char>(buf.data(), enc.size()), std::span<char>(buf.data() + offset + 1u, SZ)), dg::ud_sym_encoder::invalid_argument);
+    EXPECT_EQ(encoder.decode(std::span<const char>(buf.data(), enc.size()), std::span<char>(buf.data() + offset, SZ)), SZ);
+}
+
+//every byte of the header and the hash table, a stride through the three segments - each decode draws a dict per payload byte
+TEST(SegmentedEncoder, RejectsTamperedFrame){
+
+    constexpr size_t SZ = dg::ud_sym_encoder::SegmentedEncoder::MIN_SEGMENT_SIZE * 2u + 8u;
+
+    auto encoder    = make_segmented(3u);
+    std::string enc = encoder.encode(random_string(SZ));
+    auto positions  = std::vector<size_t>{};
+
+    for (size_t i = 0u; i < enc.size() - SZ; ++i){
+        positions.push_back(i);
+    }
+
+    for (size_t i = enc.size() - SZ; i < enc.size(); i += 509u){
+        positions.push_back(i);
+    }
+
+    positions.push_back(enc.size() - 1u);
+
+    for (size_t i: positions){
+        std::string bad = enc;
+        bad[i]          ^= 0x01;
+        ASSERT_THROW(encoder.decode(bad), dg::ud_sym_encoder::bad_encoding_format) << "byte " << i;
+    }
+}
+
+TEST(SegmentedEncoder, RejectsTruncatedFrame){
+
+    auto encoder    = make_segmented(3u);
+    std::string enc = encoder.encode(random_string(dg::ud_sym_encoder::SegmentedEncoder::MIN_SEGMENT_SIZE * 2u + 8u));
+
+    for (size_t sz: {size_t{0}, size_t{23}, size_t{24}, size_t{40}, enc.size() - 8u, enc.size() - 1u}){
+        EXPECT_THROW(encoder.decode(enc.substr(0u, sz)), dg::ud_sym_encoder::bad_encoding_format) << "sz = " << sz;
+    }
+}
+
+TEST(SegmentedEncoder, RejectsOtherSecret){
+
+    std::string enc = make_segmented(3u).encode(random_string(10000u));
+    auto other      = dg::ud_sym_encoder::SegmentedEncoder("other_secret", dg::ud_sym_encoder::mt19937{1u}, 3u, dg::ud_sym_encoder::SegmentedEncoder::MIN_SEGMENT_SIZE);
+
+    EXPECT_THROW(other.decode(enc), dg::ud_sym_encoder::bad_encoding_format);
+}
+
+//the default mode draws a dict per byte - a run of equal bytes does not encode to a run of equal bytes, and the weak mode is not decoded by the default one
+TEST(SegmentedEncoder, DefaultsToPerByteDicts){
+
+    auto encoder    = dg::ud_sym_encoder::spawn_segmented_encoder(secret(), 2u);
+    auto weak       = dg::ud_sym_encoder::spawn_weak_block_constant_segmented_encoder(secret(), 2u);
+    std::string inp = std::string(10000u, 'a');
+    std::string enc = encoder->encode(inp);
+    std::string run = enc.substr(enc.size() - inp.size());
+
+    EXPECT_GT(std::count_if(run.begin(), run.end(), [&](char c){return c != run[0];}), 0);
+    EXPECT_EQ(encoder->decode(enc), inp);
+
+    std::string weak_enc = weak->encode(inp);
+    std::string weak_run = weak_enc.substr(weak_enc.size() - inp.size());
+
+    EXPECT_EQ(std::count(weak_run.begin(), weak_run.end(), weak_run[0]), static_cast<std::ptrdiff_t>(weak_run.size()));
+    EXPECT_EQ(weak->decode(weak_enc), inp);
+    EXPECT_THROW(encoder->decode(weak_enc), dg::ud_sym_encoder::bad_encoding_format);
+}